@@ -3,6 +3,7 @@
 #include <string.h>
 #include <stdbool.h>
 #include <inttypes.h>
+#include <time.h>
 
 #define I16_HI_BIT 0x8000ull
 #define I16_MASK 0xffffull
@@ -34,6 +35,16 @@ typedef struct{
 }f128;
 // [sign:1][exp:15][mantissa:112]
 
+typedef struct{
+  f128 re;
+  f128 im;
+}c128;
+
+typedef struct{
+  size_t n;
+  c128* twiddles;// exp(-2*pi*i*k/n) for 0 <= k < n/2
+}c128_fftPlan;
+
 // declarations of functions used before initialization
 f128 f128_fromF64(double);
 double f128_toF64(f128);
@@ -45,8 +56,96 @@ f128 f128_sub(f128,f128);
 f128 f128_mult(f128,f128);
 f128 f128_inv(f128);
 f128 f128_div(f128,f128);
+f128 f128_ldexp(f128,int);
+f128 f128_frexp(f128,int*);
 
 static int f128_normalizeMantissa(f128*);
+static int f128_leadingZeros64(uint64_t);
+
+// instrumentation, enabled by compiling with -DF128_INSTRUMENT
+// counters are per-thread and include calls made internally (e.g. by f128_div)
+
+typedef enum{
+  F128_OP_ADD,
+  F128_OP_SUB,
+  F128_OP_MULT,
+  F128_OP_INV,
+  F128_OP_DIV,
+  F128_OP_COUNT
+}f128_op;
+
+static const char* f128_opNames[F128_OP_COUNT]={"add","sub","mult","inv","div"};
+
+#if __STDC_VERSION__>=201112L
+#define F128_THREAD_LOCAL _Thread_local
+#else
+#define F128_THREAD_LOCAL __thread
+#endif
+
+#ifdef F128_INSTRUMENT
+// exponent differences 0..113, last bucket for all larger differences
+#define F128_EXP_DIFF_BUCKETS 115
+
+typedef struct{
+  uint64_t calls[F128_OP_COUNT];
+  uint64_t nanInf[F128_OP_COUNT];// NaN or Infinity operand
+  uint64_t zero[F128_OP_COUNT];// zero operand
+  uint64_t normalize;// mantissa normalizations (subnormal operands, cancellation in f128_sub)
+  uint64_t expGap;// add/sub where one operand is too small to change result
+  uint64_t expDiff[F128_EXP_DIFF_BUCKETS];// difference of exponents in add/sub
+}f128_stats;
+
+static F128_THREAD_LOCAL f128_stats f128_threadStats;
+
+static void f128_countExpDiff(int32_t expX,int32_t expY){
+  int32_t diff=expX>expY?expX-expY:expY-expX;
+  f128_threadStats.expDiff[diff<F128_EXP_DIFF_BUCKETS-1?diff:F128_EXP_DIFF_BUCKETS-1]++;
+}
+
+#define F128_COUNT(counter) (f128_threadStats.counter++)
+#define F128_COUNT_EXP_DIFF(expX,expY) f128_countExpDiff(expX,expY)
+
+f128_stats f128_statsGet(void){
+  return f128_threadStats;
+}
+void f128_statsReset(void){
+  memset(&f128_threadStats,0,sizeof(f128_stats));
+}
+void f128_statsDump(FILE* out){
+  for(int i=0;i<F128_OP_COUNT;i++){
+    fprintf(out,"%-4s calls: %"PRIu64" NaN/Infinity: %"PRIu64" zero: %"PRIu64"\n",
+      f128_opNames[i],f128_threadStats.calls[i],f128_threadStats.nanInf[i],f128_threadStats.zero[i]);
+  }
+  fprintf(out,"normalize: %"PRIu64"\n",f128_threadStats.normalize);
+  fprintf(out,"exponent gap: %"PRIu64"\n",f128_threadStats.expGap);
+  fprintf(out,"exponent differences:\n");
+  for(int i=0;i<F128_EXP_DIFF_BUCKETS;i++){
+    if(f128_threadStats.expDiff[i]!=0){
+      fprintf(out,"%s%3d: %"PRIu64"\n",i==F128_EXP_DIFF_BUCKETS-1?">=":"  ",i,f128_threadStats.expDiff[i]);
+    }
+  }
+}
+#else
+#define F128_COUNT(counter) ((void)0)
+#define F128_COUNT_EXP_DIFF(expX,expY) ((void)0)
+#endif
+
+// operation tracing, enabled by compiling with -DF128_TRACE
+// calls of the operations in f128_op are appended to the file given to f128_traceStart,
+// calls nested inside another traced operation are not recorded
+// the operations are compiled as <name>Untraced and wrapped by recording functions,
+// other functions built on them call F128_UNTRACED(<name>) and are not recorded,
+// the array functions and f128_mult2/f128_mult4 record the elements that are not computed by their fast path
+#ifdef F128_TRACE
+#define F128_UNTRACED(name) name##Untraced
+f128 f128_addUntraced(f128,f128);
+f128 f128_subUntraced(f128,f128);
+f128 f128_multUntraced(f128,f128);
+f128 f128_invUntraced(f128);
+f128 f128_divUntraced(f128,f128);
+#else
+#define F128_UNTRACED(name) name
+#endif
 
 #define F64_SIGN_FLAG  0x8000000000000000ull
 #define F64_EXP_SHIFT 52
@@ -63,43 +162,64 @@ f128 f128_fromF64(double x){
   uint64_t hi= mantissa >> ( F64_EXP_SHIFT - F128_HI_EXP_SHIFT );
   uint64_t low= mantissa << ( 64 + F128_HI_EXP_SHIFT - F64_EXP_SHIFT );
   f128 r=(f128){.hi=hi,.low=low};
-  if(exp==0){// subnormal numbers
-    // +1 to compensate exponent offset
-    exp=F128_EXP_BIAS-F64_EXP_BIAS-f128_normalizeMantissa(&r)+1;
-    r.hi&=F128_HI_MANTISSA_MASK;
+  if(exp==0){
+    // zero keeps exponent 0, f128_normalizeMantissa requires a non-zero mantissa
+    if(mantissa!=0){// subnormal numbers
+      // +1 to compensate exponent offset
+      exp=F128_EXP_BIAS-F64_EXP_BIAS-f128_normalizeMantissa(&r)+1;
+      r.hi&=F128_HI_MANTISSA_MASK;
+    }
+  }else if(exp==F64_EXP_MASK){
+    // NaN / Infinity get mapped to NaN / Infinity
+    exp=F128_EXP_MASK;
   }else{
     exp+=F128_EXP_BIAS-F64_EXP_BIAS;//update bias
-    // NaN / Infinity get mapped to NaN / Infinity
   }
   r.hi|=sign|(exp<<F128_HI_EXP_SHIFT);
   return r;
 }
+// rounds to nearest (ties to even)
 double f128_toF64(f128 x){
   uint64_t sign=x.hi&F128_HI_SIGN_FLAG;
-  uint64_t exp=(x.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  int32_t exp=(x.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
   uint64_t mantissaHi=x.hi&F128_HI_MANTISSA_MASK;
   uint64_t mantissaLow=x.low;
   uint64_t mantissa= mantissaHi << ( F64_EXP_SHIFT - F128_HI_EXP_SHIFT );
   mantissa |= mantissaLow >> ( 64 + F128_HI_EXP_SHIFT - F64_EXP_SHIFT );
-  // TODO round instead of truncate
+  // bits below the double mantissa, highest bit is the rounding bit
+  uint64_t rest= mantissaLow << ( F64_EXP_SHIFT - F128_HI_EXP_SHIFT );
   if(exp==F128_EXP_MASK){ // inf/NaN
-    exp=F64_EXP_MASK;
-  }else if(exp>=F128_EXP_BIAS+F64_EXP_MASK){ // overflow (exp - bias > f64 mask)
-    exp=F64_EXP_MASK;
-    mantissa=0;
-  }else if(exp+F64_EXP_BIAS<=F128_EXP_BIAS){ // underflow ( exp -bias + f64_bias <= 0 )
-    uint64_t shift=F128_EXP_BIAS-(exp+F64_EXP_BIAS)+1;// +1 for hidden bit
-    if(shift<=F64_EXP_SHIFT){
-      mantissa=(mantissa|F64_HIDDEN_BIT)>>shift;
+    if(mantissa==0&&(mantissaHi|mantissaLow)!=0){
+      mantissa=F64_HIDDEN_BIT>>1;// keep NaN
+    }
+    return (f64_bits){.i64=sign|((uint64_t)F64_EXP_MASK<<F64_EXP_SHIFT)|mantissa}.f64;
+  }
+  if(exp==0){
+    exp=1;// exponent 0 uses same power as exponent 1
+  }else{
+    mantissa|=F64_HIDDEN_BIT;
+  }
+  exp+=F64_EXP_BIAS-(int32_t)F128_EXP_BIAS;
+  if(exp>=(int32_t)F64_EXP_MASK){ // overflow
+    return (f64_bits){.i64=sign|((uint64_t)F64_EXP_MASK<<F64_EXP_SHIFT)}.f64;
+  }
+  if(exp<1){ // underflow
+    int shift=1-exp;
+    if(shift<64){
+      rest=(mantissa<<(64-shift))|(rest>>shift)|((rest<<(64-shift))!=0);
+      mantissa>>=shift;
     }else{
+      rest=(mantissa|rest)!=0;
       mantissa=0;
     }
-    exp=0;
-  }else{
-    exp+=F64_EXP_BIAS;
-    exp-=F128_EXP_BIAS;
+    exp=1;
   }
-  return (f64_bits){.i64=sign|(exp<<F64_EXP_SHIFT)|mantissa}.f64;
+  if(rest>I64_HI_BIT||(rest==I64_HI_BIT&&(mantissa&1))){
+    // a carry into the exponent field gives the next exponent ( or Infinity )
+    mantissa++;
+  }
+  // mantissa contains the hidden bit unless the result is subnormal
+  return (f64_bits){.i64=sign|(((uint64_t)(exp-1)<<F64_EXP_SHIFT)+mantissa)}.f64;
 }
 
 bool f128_isNaN(f128 x){
@@ -128,6 +248,7 @@ int f128_compare(f128 x,f128 y){
 static int f128_normalizeMantissa(f128* x){
   if(((x->hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK)!=0)
     return 0;//already normalized
+  F128_COUNT(normalize);
   x->hi&=F128_HI_MANTISSA_MASK;// set sign bit to zero
   int shift=0,baseShift=0;
   // shift until high part non-zero
@@ -169,15 +290,210 @@ static int f128_normalizeMantissa(f128* x){
   return baseShift+shift;
 }
 
-f128 f128_add(f128 x,f128 y){
+// mantissas in add/sub have 3 additional bits (guard, round, sticky) for rounding
+#define F128_GUARD_BITS 3
+#define F128_GUARD_HIDDEN_BIT (F128_HI_HIDDEN_BIT<<F128_GUARD_BITS)
+
+typedef enum{
+  F128_ROUND_NEAREST,// ties to even
+  F128_ROUND_DOWN,// towards -Infinity
+  F128_ROUND_UP,// towards +Infinity
+  F128_ROUND_ZERO
+}f128_roundingMode;
+
+// exact result of add, sub or mult before rounding, the mantissa has guard bits as expected by f128_roundPack
+// exp is 0 for the exact zero of x-x, which is -0 when rounding down and +0 otherwise
+typedef struct{
+  uint64_t sign;
+  int32_t exp;
+  uint64_t hi;
+  uint64_t low;
+}f128_unrounded;
+
+// shift [hi:low] right by k bits, bits shifted out are collected in the lowest bit
+static void f128_shiftRightSticky(uint64_t* hi,uint64_t* low,int k){
+  if(k==0)
+    return;
+  uint64_t sticky;
+  if(k>=128){
+    sticky=(*hi|*low)!=0;
+    *hi=*low=0;
+  }else if(k>=64){
+    sticky=(*low|(k>64?*hi<<(128-k):0))!=0;
+    *low=*hi>>(k-64);
+    *hi=0;
+  }else{
+    sticky=(*low<<(64-k))!=0;
+    *low=(*low>>k)|(*hi<<(64-k));
+    *hi>>=k;
+  }
+  *low|=sticky;
+}
+// round mantissa with guard bits and pack result
+// the mantissa has its highest bit at the hidden bit position, or exp is 1 for subnormal numbers
+// inlined such that the rounding checks of other modes are removed where the mode is a constant
+// ( f128_add, f128_addDown, ... ), f128_addRounded, f128_subRounded and f128_multRounded pass the mode at runtime
+static inline f128 f128_roundPack(uint64_t sign,int32_t exp,uint64_t hi,uint64_t low,f128_roundingMode mode){
+  uint64_t guard=low&((1<<F128_GUARD_BITS)-1);
+  low=(low>>F128_GUARD_BITS)|(hi<<(64-F128_GUARD_BITS));
+  hi>>=F128_GUARD_BITS;
+  // directed rounding increases the magnitude if it rounds away from zero
+  bool away=(mode==F128_ROUND_UP&&sign==0)||(mode==F128_ROUND_DOWN&&sign!=0);
+  bool up;
+  if(mode==F128_ROUND_NEAREST){
+    uint64_t half=1<<(F128_GUARD_BITS-1);
+    up=guard>half||(guard==half&&(low&1));
+  }else{
+    up=away&&guard!=0;
+  }
+  if(up){
+    low++;
+    if(low==0){// overflow
+      hi++;
+    }
+    // rounding lead to overflow
+    if(hi>(F128_HI_HIDDEN_BIT|F128_HI_MANTISSA_MASK)){
+      // when rounding overflows, then low is zero
+      low=hi<<63;
+      hi>>=1;
+      exp++;
+    }
+  }
+  if(exp>=(int32_t)F128_EXP_MASK){// number overflowed
+    if(mode==F128_ROUND_NEAREST||away)
+      return (f128){.hi=sign|F128_INF_HI,.low=F128_INF_LOW};
+    // largest finite number
+    return (f128){.hi=sign|((F128_EXP_MASK-1)<<F128_HI_EXP_SHIFT)|F128_HI_MANTISSA_MASK,.low=I64_MAX};
+  }
+  if((hi&F128_HI_HIDDEN_BIT)==0){// subnormal
+    exp=0;
+  }
+  return (f128){
+    .hi=sign|(((uint64_t)exp)<<F128_HI_EXP_SHIFT)|(hi&F128_HI_MANTISSA_MASK),
+    .low=low
+  };
+}
+static inline f128 f128_packUnrounded(f128_unrounded r,f128_roundingMode mode){
+  if(r.exp==0)// x-x
+    return (f128){.hi=mode==F128_ROUND_DOWN?F128_HI_SIGN_FLAG:0,.low=0};
+  return f128_roundPack(r.sign,r.exp,r.hi,r.low,mode);
+}
+
+// exponent of a normal number ( not zero, subnormal, Infinity or NaN ),
+// a single unsigned comparison such that the common case needs only one predictable branch
+static bool f128_isNormalExp(int32_t exp){
+  return (uint32_t)(exp-1)<F128_EXP_MASK-1;
+}
+
+// sum of magnitudes, the mantissas include the hidden bit and the exponents are at least 1
+static f128_unrounded f128_addMantissas(uint64_t sign,int32_t expX,f128 x,int32_t expY,f128 y){
+  F128_COUNT_EXP_DIFF(expX,expY);
+  if(expX<expY){
+    f128 t=x;
+    x=y;
+    y=t;
+    int32_t e=expX;
+    expX=expY;
+    expY=e;
+  }
+  // difference of exponents > 113 -> only affects sticky bit
+  if(expX>expY+113){
+    F128_COUNT(expGap);
+  }
+  x.hi=(x.hi<<F128_GUARD_BITS)|(x.low>>(64-F128_GUARD_BITS));
+  x.low<<=F128_GUARD_BITS;
+  y.hi=(y.hi<<F128_GUARD_BITS)|(y.low>>(64-F128_GUARD_BITS));
+  y.low<<=F128_GUARD_BITS;
+  f128_shiftRightSticky(&y.hi,&y.low,expX-expY);
+  uint64_t lowSum=x.low+y.low;
+  x.hi+=y.hi+(lowSum<x.low);
+  x.low=lowSum;
+  // overflow (at most by one bit)
+  if(x.hi>=(F128_GUARD_HIDDEN_BIT<<1)){
+    f128_shiftRightSticky(&x.hi,&x.low,1);
+    expX++;
+  }
+  return (f128_unrounded){.sign=sign,.exp=expX,.hi=x.hi,.low=x.low};
+}
+// difference of magnitudes, the mantissas include the hidden bit and the exponents are at least 1
+static f128_unrounded f128_subMantissas(uint64_t sign,int32_t expX,f128 x,int32_t expY,f128 y){
+  F128_COUNT_EXP_DIFF(expX,expY);
+  // ensure |x| >= |y|
+  if(expX<expY||(expX==expY&&(x.hi<y.hi||(x.hi==y.hi&&x.low<y.low)))){
+    f128 t=x;
+    x=y;
+    y=t;
+    int32_t e=expX;
+    expX=expY;
+    expY=e;
+    sign^=F128_HI_SIGN_FLAG;
+  }else if(expX==expY&&x.hi==y.hi&&x.low==y.low){
+    // x-x -> +0 ( -0 when rounding down )
+    return (f128_unrounded){.sign=0,.exp=0,.hi=0,.low=0};
+  }
+  // difference of exponents > 113 -> only affects sticky bit
+  if(expX>expY+113){
+    F128_COUNT(expGap);
+  }
+  x.hi=(x.hi<<F128_GUARD_BITS)|(x.low>>(64-F128_GUARD_BITS));
+  x.low<<=F128_GUARD_BITS;
+  y.hi=(y.hi<<F128_GUARD_BITS)|(y.low>>(64-F128_GUARD_BITS));
+  y.low<<=F128_GUARD_BITS;
+  f128_shiftRightSticky(&y.hi,&y.low,expX-expY);
+  // [x.hi:x.low] > [y.hi:y.low]
+  x.hi-=y.hi+(y.low>x.low);
+  x.low-=y.low;
+  // normalize, exponent cannot get smaller than 1
+  int shift=(x.hi?f128_leadingZeros64(x.hi):64+f128_leadingZeros64(x.low))
+    -f128_leadingZeros64(F128_GUARD_HIDDEN_BIT);
+  if(shift>expX-1){
+    shift=expX-1;
+  }
+  if(shift>=64){
+    x.hi=x.low<<(shift-64);
+    x.low=0;
+  }else if(shift>0){
+    x.hi=(x.hi<<shift)|(x.low>>(64-shift));
+    x.low<<=shift;
+  }
+  return (f128_unrounded){.sign=sign,.exp=expX-shift,.hi=x.hi,.low=x.low};
+}
+// x+y for normal x and y
+static f128_unrounded f128_addNormalUnrounded(f128 x,f128 y){
+  uint64_t sign=x.hi&F128_HI_SIGN_FLAG;
+  bool subtract=sign!=(y.hi&F128_HI_SIGN_FLAG);
+  int32_t expX=(x.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  int32_t expY=(y.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  x.hi=(x.hi&F128_HI_MANTISSA_MASK)|F128_HI_HIDDEN_BIT;
+  y.hi=(y.hi&F128_HI_MANTISSA_MASK)|F128_HI_HIDDEN_BIT;
+  if(subtract)
+    return f128_subMantissas(sign,expX,x,expY,y);
+  return f128_addMantissas(sign,expX,x,expY,y);
+}
+static f128 f128_addNormal(f128 x,f128 y){
+  return f128_packUnrounded(f128_addNormalUnrounded(x,y),F128_ROUND_NEAREST);
+}
+// insert hidden bit, exponent 0 uses same power as exponent 1
+static void f128_unpackMantissa(f128* x,int32_t* exp){
+  x->hi&=F128_HI_MANTISSA_MASK;
+  if(*exp==0){
+    *exp=1;
+  }else{
+    x->hi|=F128_HI_HIDDEN_BIT;
+  }
+}
+static f128 f128_subSpecial(f128 x,f128 y,f128_roundingMode mode);
+// x+y with at least one operand zero, subnormal, Infinity or NaN
+static f128 f128_addSpecial(f128 x,f128 y,f128_roundingMode mode){
   if((x.hi&F128_HI_SIGN_FLAG)!=(y.hi&F128_HI_SIGN_FLAG)){
     y.hi^=F128_HI_SIGN_FLAG;
-    return f128_sub(x,y);
+    return f128_subSpecial(x,y,mode);
   }
   uint64_t sign=x.hi&F128_HI_SIGN_FLAG;
   int32_t expX=(x.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
   int32_t expY=(y.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
   if(expX==F128_EXP_MASK){
+    F128_COUNT(nanInf[F128_OP_ADD]);
     if(f128_isNaN(x)||f128_isNaN(y)){
       // NaN+y, x+NaN -> NaN
       return (f128){.hi=sign|F128_NAN_HI,.low=F128_NAN_LOW};
@@ -185,6 +501,7 @@ f128 f128_add(f128 x,f128 y){
     // Infinity+y -> Infinity
     return (f128){.hi=sign|F128_INF_HI,.low=F128_INF_LOW};
   }else if(expY==F128_EXP_MASK){
+    F128_COUNT(nanInf[F128_OP_ADD]);
     if(f128_isNaN(y)){
       // x+NaN -> NaN
       return (f128){.hi=sign|F128_NAN_HI,.low=F128_NAN_LOW};
@@ -192,98 +509,21 @@ f128 f128_add(f128 x,f128 y){
     // x+Infinity -> Infinity
     return (f128){.hi=sign|F128_INF_HI,.low=F128_INF_LOW};
   }
-  // underflow
-  if(expX>expY+113) // difference of exponents > 113 -> no change of larger number
-    return x;
-  if(expY>expX+113)
-    return y;
-  x.hi&=F128_HI_MANTISSA_MASK;
-  y.hi&=F128_HI_MANTISSA_MASK;
-  // insert hidden bit
-  if(expX==0){
-    expX=1;
-  }else{
-    x.hi |= F128_HI_HIDDEN_BIT;
-  }
-  if(expY==0){
-    expY=1;
-  }else{
-    y.hi |= F128_HI_HIDDEN_BIT;
-  }
-  int nz=0,nextBit=0;
-  uint64_t exp=expX;
-  if(expX>expY){
-    int32_t shift=expX-expY;
-    if(shift>=64){
-      nz=(y.low|(y.hi&((1<<(shift-64-1))-1)))!=0;
-      nextBit=y.hi&(1<<(shift-64-1));
-      y.low=y.hi>>(shift-64);
-      y.hi=0;
-    }else{
-      nz=(y.low&((1<<(shift-1))-1))!=0;
-      nextBit=y.low&(1<<(shift-1));
-      y.low=(y.low>>shift)|(y.hi<<(64-shift));
-      y.hi=y.hi>>shift;
-    }
-  }else if(expX!=expY){
-    exp=expY;
-    int32_t shift=expY-expX;
-    if(shift>=64){
-      nz=(x.low|(x.hi&((1<<(shift-64-1))-1)))!=0;
-      nextBit=x.hi&(1<<(shift-64-1));
-      x.low=x.hi>>(shift-64);
-      x.hi=0;
-    }else{
-      nz=(x.low&((1<<(shift-1))-1))!=0;
-      nextBit=x.low&(1<<(shift-1));
-      x.low=(x.low>>shift)|(x.hi<<(64-shift));
-      x.hi=x.hi>>shift;
-    }
-  }
-  uint64_t lowSum=x.low+y.low;
-  x.hi+=y.hi+(lowSum<x.low);
-  x.low=lowSum;
-  // overflow (at most by one bit)
-  if(x.hi>(F128_HI_HIDDEN_BIT|F128_HI_MANTISSA_MASK)){
-    nz|=nextBit;
-    nextBit=x.low&1;
-    x.low=(x.low>>1)|(x.hi<<63);
-    x.hi>>=1;
-    exp++;
-  }
-  // rounding
-  if(nextBit&&(nz||(x.low&1)==1)){
-    // round up if next bit 1 and remainder >0.5 or remainder ==0.5 and number odd
-    x.low++;
-    if(x.low==0){// overflow
-      x.hi++;
-    }
-  }
-  // rounding lead to overflow
-  if(x.hi>(F128_HI_HIDDEN_BIT|F128_HI_MANTISSA_MASK)){
-    // when rounding overflows, then x.low is zero
-    x.low=x.hi<<63;
-    x.hi>>=1;
-    exp++;
-  }
-  if(exp>=F128_EXP_MASK){// number overflowed
-    exp=F128_EXP_MASK;
-    x.hi=x.low=0;
-  }
-  x.hi&=F128_HI_MANTISSA_MASK;
-  x.hi|=sign|(exp<<F128_HI_EXP_SHIFT);
-  return x;
+  f128_unpackMantissa(&x,&expX);
+  f128_unpackMantissa(&y,&expY);
+  return f128_packUnrounded(f128_addMantissas(sign,expX,x,expY,y),mode);
 }
-// TODO check if subtraction works correctly for edge cases
-f128 f128_sub(f128 x,f128 y){
+// x-y with at least one operand zero, subnormal, Infinity or NaN
+static f128 f128_subSpecial(f128 x,f128 y,f128_roundingMode mode){
   if((x.hi&F128_HI_SIGN_FLAG)!=(y.hi&F128_HI_SIGN_FLAG)){
     y.hi^=F128_HI_SIGN_FLAG;
-    return f128_add(x,y);
+    return f128_addSpecial(x,y,mode);
   }
   uint64_t sign=x.hi&F128_HI_SIGN_FLAG;
   int32_t expX=(x.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
   int32_t expY=(y.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
   if(expX==F128_EXP_MASK){
+    F128_COUNT(nanInf[F128_OP_SUB]);
     if(f128_isNaN(x)||expY==F128_EXP_MASK){
       // NaN-y, x-NaN, Infinity-Infinity -> NaN
       return (f128){.hi=F128_NAN_HI,.low=F128_NAN_LOW};
@@ -291,6 +531,7 @@ f128 f128_sub(f128 x,f128 y){
     // Infinity-y -> Infinity
     return (f128){.hi=sign|F128_INF_HI,.low=F128_INF_LOW};
   }else if(expY==F128_EXP_MASK){
+    F128_COUNT(nanInf[F128_OP_SUB]);
     if(f128_isNaN(y)){
       // x-NaN -> NaN
       return (f128){.hi=F128_NAN_HI,.low=F128_NAN_LOW};
@@ -301,102 +542,92 @@ f128 f128_sub(f128 x,f128 y){
       .low=F128_INF_LOW
     };
   }
-  if(expX>expY+113) // difference of exponents > 113 -> no change of larger number
-    return x;
-  if(expY>expX+113)
-    return y;
-  x.hi&=F128_HI_MANTISSA_MASK;
-  y.hi&=F128_HI_MANTISSA_MASK;
-  // insert hidden bit
-  if(expX==0){
-    expX=1;
-  }else{
-    x.hi |= F128_HI_HIDDEN_BIT;
-  }
-  if(expY==0){
-    expY=1;
-  }else{
-    y.hi |= F128_HI_HIDDEN_BIT;
-  }
-  int nz=0,nextBit=0;
-  bool roundDown=false;
-  uint64_t exp=expX;
-  if(expX>expY){
-    int32_t shift=expX-expY;
-    if(shift>=64){
-      nz=(y.low|(y.hi&((1<<(shift-64-1))-1)))!=0;
-      nextBit=y.hi&(1<<(shift-64-1));
-      y.low=y.hi>>(shift-64);
-      y.hi=0;
-    }else{
-      nz=(y.low&((1<<(shift-1))-1))!=0;
-      nextBit=y.low&(1<<(shift-1));
-      y.low=(y.low>>shift)|(y.hi<<(64-shift));
-      y.hi=y.hi>>shift;
-    }
-  }else if(expX!=expY){
-    exp=expY;
-    roundDown=true;
-    int32_t shift=expY-expX;
-    if(shift>=64){
-      nz=(x.low|(x.hi&((1<<(shift-64-1))-1)))!=0;
-      nextBit=x.hi&(1<<(shift-64-1));
-      x.low=x.hi>>(shift-64);
-      x.hi=0;
-    }else{
-      nz=(x.low&((1<<(shift-1))-1))!=0;
-      nextBit=x.low&(1<<(shift-1));
-      x.low=(x.low>>shift)|(x.hi<<(64-shift));
-      x.hi=x.hi>>shift;
-    }
-  }
-  if(x.hi<y.hi||(x.hi==y.hi&&x.low<y.low)){
-    f128 t=x;
-    x=y;
-    y=t;
-    sign^=F128_HI_SIGN_FLAG;
-    roundDown=!roundDown;
-  }
-  // [x.hi:x.low] >= [y.hi:x.low]
-  x.hi-=y.hi+(y.low>x.low);
-  x.low-=y.low;
-  // rounding
-  if(nextBit&&(nz||(x.low&1)==1)){
-    // round up/down if next bit 1 and remainder >0.5 or remainder ==0.5 and number odd
-    if(roundDown){
-      x.low--;
-      if(x.low==I64_MAX){// underflow
-        x.hi--;
-      }
-    }else{
-      x.low++;
-      if(x.low==0){// overflow
-        x.hi++;
-      }
-    }
-  }
-  if((x.hi|x.low)==0){
-    exp=0;
-  }else{
-    exp-=f128_normalizeMantissa(&x);
-  }
-  if(exp<=0){ // TODO fix handling of subnormal numbers
-    exp=0;
-    // undo last shift in normalization
-    x.low=(x.low>>1)|(x.hi<<63);
-    x.hi>>=1;
-  }
-  x.hi&=F128_HI_MANTISSA_MASK;
-  x.hi|=sign|(exp<<F128_HI_EXP_SHIFT);
-  return x;
+  f128_unpackMantissa(&x,&expX);
+  f128_unpackMantissa(&y,&expY);
+  return f128_packUnrounded(f128_subMantissas(sign,expX,x,expY,y),mode);
 }
 
+// the checks for zero, subnormal, Infinity and NaN are moved out of line,
+// normal operands take a single branch to the fast path
+f128 F128_UNTRACED(f128_add)(f128 x,f128 y){
+  F128_COUNT(calls[F128_OP_ADD]);
+  int32_t expX=(x.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  int32_t expY=(y.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  if(f128_isNormalExp(expX)&f128_isNormalExp(expY))
+    return f128_addNormal(x,y);
+  // counted here since f128_addSpecial passes operands with different signs to f128_subSpecial
+  if((((x.hi&~F128_HI_SIGN_FLAG)|x.low)==0)||(((y.hi&~F128_HI_SIGN_FLAG)|y.low)==0))
+    F128_COUNT(zero[F128_OP_ADD]);
+  return f128_addSpecial(x,y,F128_ROUND_NEAREST);
+}
+f128 F128_UNTRACED(f128_sub)(f128 x,f128 y){
+  F128_COUNT(calls[F128_OP_SUB]);
+  int32_t expX=(x.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  int32_t expY=(y.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  y.hi^=F128_HI_SIGN_FLAG;
+  if(f128_isNormalExp(expX)&f128_isNormalExp(expY))
+    return f128_addNormal(x,y);
+  y.hi^=F128_HI_SIGN_FLAG;
+  if((((x.hi&~F128_HI_SIGN_FLAG)|x.low)==0)||(((y.hi&~F128_HI_SIGN_FLAG)|y.low)==0))
+    F128_COUNT(zero[F128_OP_SUB]);
+  return f128_subSpecial(x,y,F128_ROUND_NEAREST);
+}
 
-f128 f128_mult(f128 x,f128 y){
+
+// 128-bit product of two 64-bit integers, returns low 64 bits
+static inline uint64_t f128_mult64(uint64_t a,uint64_t b,uint64_t* hi){
+  uint64_t aLow=a&I32_MASK;
+  uint64_t aHi=a>>32;
+  uint64_t bLow=b&I32_MASK;
+  uint64_t bHi=b>>32;
+  uint64_t x00=aLow*bLow;
+  uint64_t x01=aLow*bHi;
+  uint64_t x10=aHi*bLow;
+  uint64_t mid=(x00>>32)+(x01&I32_MASK)+(x10&I32_MASK);
+  *hi=aHi*bHi+(x01>>32)+(x10>>32)+(mid>>32);
+  return (x00&I32_MASK)|(mid<<32);
+}
+// exact 226-bit product p of the 113-bit mantissas [xHi:xLow] and [yHi:yLow], p[0] is the least significant word
+static inline void f128_multExact(uint64_t xHi,uint64_t xLow,uint64_t yHi,uint64_t yLow,uint64_t* p){
+  uint64_t midHi0,midHi1;
+  p[0]=f128_mult64(xLow,yLow,&p[1]);
+  uint64_t mid0=f128_mult64(xHi,yLow,&midHi0);
+  uint64_t mid1=f128_mult64(xLow,yHi,&midHi1);
+  p[2]=f128_mult64(xHi,yHi,&p[3]);
+  p[1]+=mid0;
+  uint64_t carry=p[1]<mid0;
+  p[1]+=mid1;
+  carry+=p[1]<mid1;
+  p[2]+=midHi0+carry;
+  p[3]+=p[2]<midHi0+carry;
+  p[2]+=midHi1;
+  p[3]+=p[2]<midHi1;
+}
+// product of mantissas ( without exponent and sign bits ) with exponents adjusted for subnormal inputs
+static f128_unrounded f128_multMantissas(uint64_t sign,int32_t expX,f128 x,int32_t expY,f128 y){
+  uint64_t p[4];
+  f128_multExact(x.hi|F128_HI_HIDDEN_BIT,x.low,y.hi|F128_HI_HIDDEN_BIT,y.low,p);
+  // the leading bit is at position 224 or 225 ( s=1 )
+  int s=(int)(p[3]>>(225-192));
+  // sum contains bias twice -> compensate for extra bias
+  int32_t exp=expX+expY-(int32_t)F128_EXP_BIAS+s;
+  // keep 113 bits and the guard bits, the remaining bits are collected in the sticky bit
+  uint64_t low=(p[1]>>(45+s))|(p[2]<<(19-s));
+  uint64_t hi=(p[2]>>(45+s))|(p[3]<<(19-s));
+  low|=((p[1]&((1ull<<(45+s))-1))|p[0])!=0;
+  if(exp<1){// subnormal
+    f128_shiftRightSticky(&hi,&low,1-exp>128?128:1-exp);
+    exp=1;
+  }
+  return (f128_unrounded){.sign=sign,.exp=exp,.hi=hi,.low=low};
+}
+// x*y with at least one operand zero, subnormal, Infinity or NaN
+static f128 f128_multSpecial(f128 x,f128 y,f128_roundingMode mode){
   uint64_t sign=(x.hi&F128_HI_SIGN_FLAG)^(y.hi&F128_HI_SIGN_FLAG);
   int32_t expX=(x.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
   int32_t expY=(y.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
   if(expX==F128_EXP_MASK){//x infinity and NaN
+    F128_COUNT(nanInf[F128_OP_MULT]);
     if(f128_isNaN(x)||f128_isNaN(y)||(((y.hi&~F128_HI_SIGN_FLAG)|y.low)==0)){
       // NaN*y, x*NaN, Infinity*0 -> NaN
       return (f128){.hi=sign|F128_NAN_HI,.low=F128_NAN_LOW};
@@ -404,6 +635,7 @@ f128 f128_mult(f128 x,f128 y){
     // Infinity*y -> Infinity
     return (f128){.hi=sign|F128_INF_HI,.low=F128_INF_LOW};
   }else if(expY==F128_EXP_MASK){//y infinity or NaN
+    F128_COUNT(nanInf[F128_OP_MULT]);
     if(f128_isNaN(y)||(((x.hi&~F128_HI_SIGN_FLAG)|x.low)==0)){ // x is Finite by first if
       // x*NaN, +*Infinity -> NaN
       return (f128){.hi=sign|F128_NAN_HI,.low=F128_NAN_LOW};
@@ -415,6 +647,7 @@ f128 f128_mult(f128 x,f128 y){
   y.hi&=F128_HI_MANTISSA_MASK;
   if(expX==0){
     if((x.hi|x.low)==0){// 0*y -> 0
+      F128_COUNT(zero[F128_OP_MULT]);
       return (f128){.hi=sign,.low=0};
     }
     expX=1;// exponent 0 uses same power as exponent 1
@@ -422,144 +655,95 @@ f128 f128_mult(f128 x,f128 y){
   }
   if(expY==0){
     if((y.hi|y.low)==0){// x*0 -> 0
+      F128_COUNT(zero[F128_OP_MULT]);
       return (f128){.hi=sign,.low=0};
     }
     expY=1;// exponent 0 uses same power as exponent 1
     expY-=f128_normalizeMantissa(&y);
   }
-  // multiply 113 bit mantissas
-  uint64_t a = (x.hi|F128_HI_HIDDEN_BIT) >> 32;
-  uint64_t b = (x.hi) & I32_MASK;
-  uint64_t c = (x.low >> 32) & I32_MASK;
-  uint64_t d = (x.low) & I32_MASK;
-  uint64_t e = (y.hi|F128_HI_HIDDEN_BIT) >> 32;
-  uint64_t f = (y.hi) & I32_MASK;;
-  uint64_t g = (y.low >> 32) & I32_MASK;
-  uint64_t h = (y.low) & I32_MASK;
-  uint64_t low=0,mid=0,hi=0,tmp;
-  int nz=0, leading;// low bits are not zero
-  // have to calculate all digits to get correct rounding
-  // offset 0: dh
-  tmp=d*h;
-  low+=tmp & I32_MASK;
-  mid+=tmp>>32;
-  // shift result by 32
-  nz+=(low & I32_MASK)!=0;
-  mid+=low>>32;
-  low=mid;mid=0;
-  // offset 32: ch dg
-  tmp=c*h;
-  low+=tmp & I32_MASK;
-  mid+=tmp>>32;
-  tmp=d*g;
-  low+=tmp & I32_MASK;
-  mid+=tmp>>32;
-  // shift result by 32
-  nz+=(low & I32_MASK)!=0;
-  mid+=low>>32;
-  low=mid;mid=0;
-  // offset 64: bh cg df
-  tmp=b*h;
-  low+=tmp & I32_MASK;
-  mid+=tmp>>32;
-  tmp=c*g;
-  low+=tmp & I32_MASK;
-  mid+=tmp>>32;
-  tmp=d*f;
-  low+=tmp & I32_MASK;
-  mid+=tmp>>32;
-  // shift result by 32
-  nz+=(low & I32_MASK)!=0;
-  mid+=low>>32;
-  low=mid;mid=0;
-  // offset 96: ah bg cf de
-  tmp=a*h;
-  low+=tmp & I32_MASK;
-  mid+=tmp>>32;
-  tmp=b*g;
-  low+=tmp & I32_MASK;
-  mid+=tmp>>32;
-  tmp=c*f;
-  low+=tmp & I32_MASK;
-  mid+=tmp>>32;
-  tmp=d*e;
-  low+=tmp & I32_MASK;
-  mid+=tmp>>32;
-  // shift result by 16
-  nz+=(low & I16_MASK)!=0;
-  leading=(low & I16_HI_BIT)!=0;//next bit after number
-  low=(low>>16)+((mid & I16_MASK)<<16);
-  mid>>=16;
-  // offset 128: ag bf ce
-  tmp=a*g;
-  low+=(tmp & I16_MASK)<<16;
-  mid+=tmp>>16;
-  tmp=b*f;
-  low+=(tmp & I16_MASK)<<16;
-  mid+=tmp>>16;
-  tmp=c*e;
-  low+=(tmp & I16_MASK)<<16;
-  mid+=tmp>>16;
-  // offset 160: af be
-  tmp=a*f;
-  mid+=(tmp & I16_MASK)<<16;
-  hi+=tmp>>16;
-  tmp=b*e;
-  mid+=(tmp & I16_MASK)<<16;
-  hi+=tmp>>16;
-  // offset 192: ae
-  hi+=(a*e)<<16;// a,e<2^17 -> ae < 2^34
-  // merge numbers to one 128-bit number in hi:low
-  mid+=(low>>32) & I32_MASK;
-  low=(low & I32_MASK)|((mid & I32_MASK)<<32);
-  hi+=(mid>>32) & I32_MASK;
-  // truncate number to 112 bits
-  tmp = hi >> 48; // should be between 1 and 4 (inclusive)
-  int shift = tmp==1 ? 0 : tmp < 4 ? 1 : 2 ;
-  if( tmp >> shift != 1 ){
-    fprintf(stderr,"unexpected value for hi bits %"PRIu64"\n",tmp);
-  }
-  if(shift!=0){
-    leading=(low>>(shift-1))&1;
-  }
-  if(leading&&(nz||((low>>shift)&1)==1)){
-    // round up if next bit 1 and remainder >0.5 or remainder ==0.5 and number odd
-    low++;
-    if(low==0){// overflow
-      hi++;
-      if(hi>(1ull<<(shift+1))){
-        shift++;
-      }
-    }
-  }
-  low >>=shift;
-  if(shift!=0){
-    low |= hi<<(64-shift);
-  }
-  hi =(hi>>shift) & F128_HI_MANTISSA_MASK;
-  // sum contains bias twice -> compensate for extra bias
-  int32_t exp=expX+expY+shift-F128_EXP_BIAS;
-  if(exp>=(int64_t)F128_EXP_MASK){ // overflow
-    exp=F128_EXP_MASK;
-    hi=low=0;
-  }else if(exp<1){ // underflow
-    hi|=F128_HI_HIDDEN_BIT;
-    // 1 for hidden bit,+ 1 for every power of two below 0
-    int32_t shift=1-exp;
-    exp=0;
-    // subnormal
-    if(shift>112){
-      hi=low=0;
-    }else if(shift>=64){
-      low=hi>>(shift-64);
-      hi=0;
-    }else{
-      low=(low>>shift)|(hi<<(64-shift));
-      hi>>=shift;
-    }
+  return f128_packUnrounded(f128_multMantissas(sign,expX,x,expY,y),mode);
+}
+// x*y for normal x and y
+static f128_unrounded f128_multNormalUnrounded(f128 x,f128 y){
+  uint64_t sign=(x.hi&F128_HI_SIGN_FLAG)^(y.hi&F128_HI_SIGN_FLAG);
+  int32_t expX=(x.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  int32_t expY=(y.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  x.hi&=F128_HI_MANTISSA_MASK;
+  y.hi&=F128_HI_MANTISSA_MASK;
+  return f128_multMantissas(sign,expX,x,expY,y);
+}
+static f128 f128_multNormal(f128 x,f128 y){
+  return f128_packUnrounded(f128_multNormalUnrounded(x,y),F128_ROUND_NEAREST);
+}
+f128 F128_UNTRACED(f128_mult)(f128 x,f128 y){
+  F128_COUNT(calls[F128_OP_MULT]);
+  int32_t expX=(x.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  int32_t expY=(y.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  if(f128_isNormalExp(expX)&f128_isNormalExp(expY))
+    return f128_multNormal(x,y);
+  return f128_multSpecial(x,y,F128_ROUND_NEAREST);
+}
+
+// operations with directed rounding, the mode selects the rounding of f128_roundPack
+static inline f128 f128_addMode(f128 x,f128 y,f128_roundingMode mode){
+  int32_t expX=(x.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  int32_t expY=(y.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  if(f128_isNormalExp(expX)&f128_isNormalExp(expY))
+    return f128_packUnrounded(f128_addNormalUnrounded(x,y),mode);
+  return f128_addSpecial(x,y,mode);
+}
+static inline f128 f128_subMode(f128 x,f128 y,f128_roundingMode mode){
+  int32_t expX=(x.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  int32_t expY=(y.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  if(f128_isNormalExp(expX)&f128_isNormalExp(expY)){
+    y.hi^=F128_HI_SIGN_FLAG;
+    return f128_packUnrounded(f128_addNormalUnrounded(x,y),mode);
   }
-  // update exponent & sign
-  return (f128){.hi=sign|(((uint64_t)exp)<<F128_HI_EXP_SHIFT)|hi,.low=low};
+  return f128_subSpecial(x,y,mode);
+}
+static inline f128 f128_multMode(f128 x,f128 y,f128_roundingMode mode){
+  int32_t expX=(x.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  int32_t expY=(y.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  if(f128_isNormalExp(expX)&f128_isNormalExp(expY))
+    return f128_packUnrounded(f128_multNormalUnrounded(x,y),mode);
+  return f128_multSpecial(x,y,mode);
+}
+f128 f128_addRounded(f128 x,f128 y,f128_roundingMode mode){
+  return f128_addMode(x,y,mode);
+}
+f128 f128_subRounded(f128 x,f128 y,f128_roundingMode mode){
+  return f128_subMode(x,y,mode);
+}
+f128 f128_multRounded(f128 x,f128 y,f128_roundingMode mode){
+  return f128_multMode(x,y,mode);
+}
+// one function per mode, for callers that use a fixed mode
+f128 f128_addDown(f128 x,f128 y){
+  return f128_addMode(x,y,F128_ROUND_DOWN);
+}
+f128 f128_addUp(f128 x,f128 y){
+  return f128_addMode(x,y,F128_ROUND_UP);
+}
+f128 f128_addZero(f128 x,f128 y){
+  return f128_addMode(x,y,F128_ROUND_ZERO);
+}
+f128 f128_subDown(f128 x,f128 y){
+  return f128_subMode(x,y,F128_ROUND_DOWN);
+}
+f128 f128_subUp(f128 x,f128 y){
+  return f128_subMode(x,y,F128_ROUND_UP);
+}
+f128 f128_subZero(f128 x,f128 y){
+  return f128_subMode(x,y,F128_ROUND_ZERO);
+}
+f128 f128_multDown(f128 x,f128 y){
+  return f128_multMode(x,y,F128_ROUND_DOWN);
+}
+f128 f128_multUp(f128 x,f128 y){
+  return f128_multMode(x,y,F128_ROUND_UP);
+}
+f128 f128_multZero(f128 x,f128 y){
+  return f128_multMode(x,y,F128_ROUND_ZERO);
 }
 
 #define MIN_INVERTABLE_HI 0x400000000000
@@ -574,21 +758,23 @@ static f128 f128_normalizedInv(f128 x){
   f128 q=f128_fromF64(32/17.0);
   f128 two=f128_fromF64(2);
   // estimate 1/x as 48/17 - 32/17 * x
-  f128 y=f128_sub(p,f128_mult(x,q));
+  f128 y=F128_UNTRACED(f128_sub)(p,F128_UNTRACED(f128_mult)(x,q));
   // iteration step: y2 = y1(2 - x * y1)
   // 5 iteration steps should be enough
-  y = f128_mult(y,f128_sub(two,f128_mult(x,y)));
-  y = f128_mult(y,f128_sub(two,f128_mult(x,y)));
-  y = f128_mult(y,f128_sub(two,f128_mult(x,y)));
-  y = f128_mult(y,f128_sub(two,f128_mult(x,y)));
-  y = f128_mult(y,f128_sub(two,f128_mult(x,y)));
+  y = F128_UNTRACED(f128_mult)(y,F128_UNTRACED(f128_sub)(two,F128_UNTRACED(f128_mult)(x,y)));
+  y = F128_UNTRACED(f128_mult)(y,F128_UNTRACED(f128_sub)(two,F128_UNTRACED(f128_mult)(x,y)));
+  y = F128_UNTRACED(f128_mult)(y,F128_UNTRACED(f128_sub)(two,F128_UNTRACED(f128_mult)(x,y)));
+  y = F128_UNTRACED(f128_mult)(y,F128_UNTRACED(f128_sub)(two,F128_UNTRACED(f128_mult)(x,y)));
+  y = F128_UNTRACED(f128_mult)(y,F128_UNTRACED(f128_sub)(two,F128_UNTRACED(f128_mult)(x,y)));
   return y;
 }
 
-f128 f128_inv(f128 x){
+f128 F128_UNTRACED(f128_inv)(f128 x){
+  F128_COUNT(calls[F128_OP_INV]);
   uint64_t sign=x.hi&F128_HI_SIGN_FLAG;
   int32_t expX=(x.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
   if(expX==F128_EXP_MASK){
+    F128_COUNT(nanInf[F128_OP_INV]);
     if(f128_isNaN(x)){
       return x;
     }
@@ -596,6 +782,7 @@ f128 f128_inv(f128 x){
     return (f128){.hi=sign,.low=0};
   }else if(expX==0){
     if(x.hi<MIN_INVERTABLE_HI){// 1/0 = Infinity
+      F128_COUNT(zero[F128_OP_INV]);
       // 1/[MIN_INVERTABLE_HI, 0] = +Infinity
       //  and all smaller numbers have finite inverse
       return (f128){.hi=sign|F128_INF_HI,.low=F128_INF_LOW};
@@ -628,40 +815,8 @@ f128 f128_inv(f128 x){
   y.hi|=sign|((((uint64_t)expY)&F128_EXP_MASK)<<F128_HI_EXP_SHIFT);
   return y;
 }
-f128 f128_div(f128 x,f128 y){
-  uint64_t sign=(x.hi&F128_HI_SIGN_FLAG)^(y.hi&F128_HI_SIGN_FLAG);
-  int32_t expX=(x.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
-  int32_t expY=(y.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
-  if(expX==F128_EXP_MASK){
-    if(f128_isNaN(x)||expY==F128_EXP_MASK){
-      // NaN/y, NaN/NaN, Infinity/Infinity -> NaN
-      return (f128){.hi=sign|F128_NAN_HI,.low=F128_NAN_LOW};
-    }
-    // Infinity/y, Infinity/0 = Infinity
-    return (f128){.hi=sign|F128_INF_HI,.low=F128_INF_LOW};
-  }else if(expY==F128_EXP_MASK){
-    if(f128_isNaN(y)){
-      // x/NaN -> NaN
-      return (f128){.hi=sign|F128_NAN_HI,.low=F128_NAN_LOW};
-    }
-    // x/Infinity, 0/Infinity = 0
-    return (f128){.hi=sign,.low=0};
-  }else if((expY|(y.hi&F128_HI_MANTISSA_MASK)|y.low)==0){// y==0
-    if((expX|(x.hi&F128_HI_MANTISSA_MASK)|x.low)==0){// x==0
-      // 0 / 0 -> NaN
-      return (f128){.hi=sign|F128_NAN_HI,.low=F128_NAN_LOW};
-    }
-    // x / 0 -> Infinity
-    return (f128){.hi=sign|F128_INF_HI,.low=F128_INF_LOW};
-  }
-  if(expX==0){
-    expX=1;// exponent 0 uses same power as exponent 1
-    expX-=f128_normalizeMantissa(&x);
-  }
-  if(expY==0){
-    expY=1;// exponent 0 uses same power as exponent 1
-    expY-=f128_normalizeMantissa(&y);
-  }
+// quotient of non-zero finite numbers, subnormal inputs are normalized with adjusted exponents
+static f128 f128_divMantissas(uint64_t sign,int32_t expX,f128 x,int32_t expY,f128 y){
   // scale x such that 0.5 <= x < 1
   int32_t delta=expY-F128_EXP_BIAS+1;
   y.hi=(y.hi&F128_HI_MANTISSA_MASK)|((F128_EXP_BIAS-1)<<F128_HI_EXP_SHIFT);
@@ -676,7 +831,7 @@ f128 f128_div(f128 x,f128 y){
     expX=1;
   }
   x.hi=(x.hi&F128_HI_MANTISSA_MASK)|(((uint64_t)expX)<<F128_HI_EXP_SHIFT);
-  x=f128_mult(x,y);
+  x=F128_UNTRACED(f128_mult)(x,y);
   if(delta>0){
     expX=(x.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
     expX-=delta;
@@ -701,12 +856,2532 @@ f128 f128_div(f128 x,f128 y){
   x.hi|=sign;
   return x;
 }
-
-int main(void){
-  f128 a={(F128_EXP_BIAS<<F128_HI_EXP_SHIFT)|1,0},
-       b={(F128_EXP_BIAS<<F128_HI_EXP_SHIFT)|1,0},c=f128_mult(a,b);
-  printf("%016lx %016lx\n",a.hi,a.low);
-  printf("%016lx %016lx\n",b.hi,b.low);
+// x/y with at least one operand zero, subnormal, Infinity or NaN
+static f128 f128_divSpecial(uint64_t sign,int32_t expX,f128 x,int32_t expY,f128 y){
+  if(expX==F128_EXP_MASK){
+    F128_COUNT(nanInf[F128_OP_DIV]);
+    if(f128_isNaN(x)||expY==F128_EXP_MASK){
+      // NaN/y, NaN/NaN, Infinity/Infinity -> NaN
+      return (f128){.hi=sign|F128_NAN_HI,.low=F128_NAN_LOW};
+    }
+    // Infinity/y, Infinity/0 = Infinity
+    return (f128){.hi=sign|F128_INF_HI,.low=F128_INF_LOW};
+  }else if(expY==F128_EXP_MASK){
+    F128_COUNT(nanInf[F128_OP_DIV]);
+    if(f128_isNaN(y)){
+      // x/NaN -> NaN
+      return (f128){.hi=sign|F128_NAN_HI,.low=F128_NAN_LOW};
+    }
+    // x/Infinity, 0/Infinity = 0
+    return (f128){.hi=sign,.low=0};
+  }else if((expY|(y.hi&F128_HI_MANTISSA_MASK)|y.low)==0){// y==0
+    F128_COUNT(zero[F128_OP_DIV]);
+    if((expX|(x.hi&F128_HI_MANTISSA_MASK)|x.low)==0){// x==0
+      // 0 / 0 -> NaN
+      return (f128){.hi=sign|F128_NAN_HI,.low=F128_NAN_LOW};
+    }
+    // x / 0 -> Infinity
+    return (f128){.hi=sign|F128_INF_HI,.low=F128_INF_LOW};
+  }else if((expX|(x.hi&F128_HI_MANTISSA_MASK)|x.low)==0){// x==0
+    F128_COUNT(zero[F128_OP_DIV]);
+    // 0 / y -> 0, must be handled here since f128_normalizeMantissa requires a non-zero mantissa
+    return (f128){.hi=sign,.low=0};
+  }
+  if(expX==0){
+    expX=1;// exponent 0 uses same power as exponent 1
+    expX-=f128_normalizeMantissa(&x);
+  }
+  if(expY==0){
+    expY=1;// exponent 0 uses same power as exponent 1
+    expY-=f128_normalizeMantissa(&y);
+  }
+  return f128_divMantissas(sign,expX,x,expY,y);
+}
+// x/y for normal x and y
+static f128 f128_divNormal(f128 x,f128 y){
+  uint64_t sign=(x.hi&F128_HI_SIGN_FLAG)^(y.hi&F128_HI_SIGN_FLAG);
+  int32_t expX=(x.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  int32_t expY=(y.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  return f128_divMantissas(sign,expX,x,expY,y);
+}
+f128 F128_UNTRACED(f128_div)(f128 x,f128 y){
+  F128_COUNT(calls[F128_OP_DIV]);
+  int32_t expX=(x.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  int32_t expY=(y.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  if(f128_isNormalExp(expX)&f128_isNormalExp(expY))
+    return f128_divNormal(x,y);
+  return f128_divSpecial((x.hi&F128_HI_SIGN_FLAG)^(y.hi&F128_HI_SIGN_FLAG),expX,x,expY,y);
+}
+
+// classification
+
+typedef enum{
+  F128_CLASS_ZERO,
+  F128_CLASS_SUBNORMAL,
+  F128_CLASS_NORMAL,
+  F128_CLASS_INFINITY,
+  F128_CLASS_NAN,
+  F128_CLASS_COUNT
+}f128_class;
+
+// bit of class c in the mask returned by f128_classifyArray
+#define F128_CLASS_BIT(c) (1u<<(c))
+// number of elements checked at once by the array operations
+#define F128_CLASSIFY_BLOCK_SIZE 64
+
+f128_class f128_classify(f128 x){
+  int32_t exp=(x.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  if(f128_isNormalExp(exp))
+    return F128_CLASS_NORMAL;
+  bool mantissa=((x.hi&F128_HI_MANTISSA_MASK)|x.low)!=0;
+  if(exp==0)
+    return mantissa?F128_CLASS_SUBNORMAL:F128_CLASS_ZERO;
+  return mantissa?F128_CLASS_NAN:F128_CLASS_INFINITY;
+}
+// stores the class of each value in classes (if not NULL),
+// returns a bitmask containing F128_CLASS_BIT of all classes occurring in values
+unsigned int f128_classifyArray(const f128* values,f128_class* classes,size_t count){
+  unsigned int mask=0;
+  if(classes==NULL){
+    // only check exponents until a value that is not normal is found
+    size_t i=0;
+    while(i<count&&f128_isNormalExp((values[i].hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK)){
+      i++;
+    }
+    if(i>0){
+      mask=F128_CLASS_BIT(F128_CLASS_NORMAL);
+    }
+    for(;i<count;i++){
+      mask|=F128_CLASS_BIT(f128_classify(values[i]));
+    }
+    return mask;
+  }
+  for(size_t i=0;i<count;i++){
+    classes[i]=f128_classify(values[i]);
+    mask|=F128_CLASS_BIT(classes[i]);
+  }
+  return mask;
+}
+// true if x[0..count) and y[0..count) only contain normal numbers
+static bool f128_isNormalBlock(const f128* x,const f128* y,size_t count){
+  int32_t special=0;
+  for(size_t i=0;i<count;i++){
+    special|=!f128_isNormalExp((x[i].hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK);
+    special|=!f128_isNormalExp((y[i].hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK);
+  }
+  return special==0;
+}
+
+// element-wise operations, blocks of F128_CLASSIFY_BLOCK_SIZE normal numbers skip the checks for special operands,
+// the fast path is not counted by the instrumentation and not recorded in traces
+void f128_addArray(const f128* x,const f128* y,f128* out,size_t count){
+  for(size_t start=0;start<count;start+=F128_CLASSIFY_BLOCK_SIZE){
+    size_t end=count-start>F128_CLASSIFY_BLOCK_SIZE?start+F128_CLASSIFY_BLOCK_SIZE:count;
+    if(f128_isNormalBlock(x+start,y+start,end-start)){
+      for(size_t i=start;i<end;i++){
+        out[i]=f128_addNormal(x[i],y[i]);
+      }
+    }else{
+      for(size_t i=start;i<end;i++){
+        out[i]=f128_add(x[i],y[i]);
+      }
+    }
+  }
+}
+void f128_subArray(const f128* x,const f128* y,f128* out,size_t count){
+  for(size_t start=0;start<count;start+=F128_CLASSIFY_BLOCK_SIZE){
+    size_t end=count-start>F128_CLASSIFY_BLOCK_SIZE?start+F128_CLASSIFY_BLOCK_SIZE:count;
+    if(f128_isNormalBlock(x+start,y+start,end-start)){
+      for(size_t i=start;i<end;i++){
+        out[i]=f128_addNormal(x[i],(f128){.hi=y[i].hi^F128_HI_SIGN_FLAG,.low=y[i].low});
+      }
+    }else{
+      for(size_t i=start;i<end;i++){
+        out[i]=f128_sub(x[i],y[i]);
+      }
+    }
+  }
+}
+void f128_multArray(const f128* x,const f128* y,f128* out,size_t count){
+  for(size_t start=0;start<count;start+=F128_CLASSIFY_BLOCK_SIZE){
+    size_t end=count-start>F128_CLASSIFY_BLOCK_SIZE?start+F128_CLASSIFY_BLOCK_SIZE:count;
+    if(f128_isNormalBlock(x+start,y+start,end-start)){
+      for(size_t i=start;i<end;i++){
+        out[i]=f128_multNormal(x[i],y[i]);
+      }
+    }else{
+      for(size_t i=start;i<end;i++){
+        out[i]=f128_mult(x[i],y[i]);
+      }
+    }
+  }
+}
+void f128_divArray(const f128* x,const f128* y,f128* out,size_t count){
+  for(size_t start=0;start<count;start+=F128_CLASSIFY_BLOCK_SIZE){
+    size_t end=count-start>F128_CLASSIFY_BLOCK_SIZE?start+F128_CLASSIFY_BLOCK_SIZE:count;
+    if(f128_isNormalBlock(x+start,y+start,end-start)){
+      for(size_t i=start;i<end;i++){
+        out[i]=f128_divNormal(x[i],y[i]);
+      }
+    }else{
+      for(size_t i=start;i<end;i++){
+        out[i]=f128_div(x[i],y[i]);
+      }
+    }
+  }
+}
+
+// fused operations: products are computed exactly and rounded once
+
+// value = m * 2^(exp-F128_EXP_BIAS-F128_WIDE_POINT), m[0] is the least significant word
+#define F128_WIDE_POINT 224
+// normalized mantissas have their highest bit at this position,
+// leaving room for the carry of an addition
+#define F128_WIDE_LEADING_BIT 253
+
+typedef struct{
+  uint64_t sign;
+  int32_t exp;
+  uint64_t m[4];
+}f128_wide;
+
+static bool f128_wideIsZero(const f128_wide* x){
+  return (x->m[0]|x->m[1]|x->m[2]|x->m[3])==0;
+}
+// shift mantissa right by k bits, bits shifted out are collected in the lowest bit
+static void f128_wideShiftRightSticky(f128_wide* x,int k){
+  if(k==0)
+    return;
+  uint64_t sticky=0;
+  if(k>=256){
+    sticky=!f128_wideIsZero(x);
+    x->m[0]=x->m[1]=x->m[2]=x->m[3]=0;
+  }else{
+    int words=k/64,bits=k%64;
+    for(int i=0;i<words;i++)
+      sticky|=x->m[i];
+    if(bits>0)
+      sticky|=x->m[words]<<(64-bits);
+    for(int i=0;i<4;i++){
+      uint64_t v=i+words<4?x->m[i+words]>>bits:0;
+      if(bits>0&&i+words+1<4)
+        v|=x->m[i+words+1]<<(64-bits);
+      x->m[i]=v;
+    }
+  }
+  x->m[0]|=sticky!=0;
+}
+// shift mantissa such that the highest bit is at F128_WIDE_LEADING_BIT
+static void f128_wideNormalize(f128_wide* x){
+  int i=3;
+  while(i>=0&&x->m[i]==0)
+    i--;
+  if(i<0)
+    return;
+  int shift=F128_WIDE_LEADING_BIT-(64*i+63-f128_leadingZeros64(x->m[i]));
+  if(shift<0){// carry of addition
+    f128_wideShiftRightSticky(x,-shift);
+    x->exp-=shift;
+    return;
+  }
+  int words=shift/64,bits=shift%64;
+  for(int k=3;k>=0;k--){
+    uint64_t v=k-words>=0?x->m[k-words]<<bits:0;
+    if(bits>0&&k-words-1>=0)
+      v|=x->m[k-words-1]>>(64-bits);
+    x->m[k]=v;
+  }
+  x->exp-=shift;
+}
+// unpack finite x
+static f128_wide f128_unpackWide(f128 x){
+  int32_t exp=(x.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  uint64_t hi=x.hi&F128_HI_MANTISSA_MASK;
+  if(exp==0){
+    exp=1;
+  }else{
+    hi|=F128_HI_HIDDEN_BIT;
+  }
+  // mantissa * 2^(F128_WIDE_POINT-112)
+  f128_wide r={
+    .sign=x.hi&F128_HI_SIGN_FLAG,
+    .exp=exp,
+    .m={0,x.low<<48,(x.low>>16)|(hi<<48),hi>>16}
+  };
+  f128_wideNormalize(&r);
+  return r;
+}
+// add [hi:low] to m at word k
+static void f128_wideAddAt(uint64_t* m,int k,uint64_t low,uint64_t hi){
+  m[k]+=low;
+  uint64_t carry=m[k]<low;
+  m[k+1]+=hi;
+  uint64_t carry2=m[k+1]<hi;
+  m[k+1]+=carry;
+  carry2+=m[k+1]<carry;
+  for(int i=k+2;i<4&&carry2;i++){
+    m[i]+=carry2;
+    carry2=m[i]==0;
+  }
+}
+// exact product of unpacked finite values
+static f128_wide f128_multUnpacked(const f128_wide* a,const f128_wide* b){
+  // normalized mantissas are in the upper two words, the product of these words
+  // is 2^256 times smaller than the product of the full mantissas
+  f128_wide r={
+    .sign=a->sign^b->sign,
+    .exp=a->exp+b->exp-F128_EXP_BIAS+256-F128_WIDE_POINT,
+    .m={0,0,0,0}
+  };
+  uint64_t hi,low;
+  r.m[0]=f128_mult64(a->m[2],b->m[2],&r.m[1]);
+  r.m[2]=f128_mult64(a->m[3],b->m[3],&r.m[3]);
+  low=f128_mult64(a->m[2],b->m[3],&hi);
+  f128_wideAddAt(r.m,1,low,hi);
+  low=f128_mult64(a->m[3],b->m[2],&hi);
+  f128_wideAddAt(r.m,1,low,hi);
+  f128_wideNormalize(&r);
+  return r;
+}
+// exact product of finite x and y
+static f128_wide f128_multWide(f128 x,f128 y){
+  f128_wide a=f128_unpackWide(x),b=f128_unpackWide(y);
+  return f128_multUnpacked(&a,&b);
+}
+// exact sum of normalized x and y ( up to the sticky bit )
+static f128_wide f128_wideAdd(f128_wide x,f128_wide y){
+  if(f128_wideIsZero(&y))
+    return x;
+  if(f128_wideIsZero(&x))
+    return y;
+  // ensure |x| >= |y|
+  bool swap=x.exp<y.exp;
+  if(x.exp==y.exp){
+    for(int i=3;i>=0;i--){
+      if(x.m[i]!=y.m[i]){
+        swap=x.m[i]<y.m[i];
+        break;
+      }
+    }
+  }
+  if(swap){
+    f128_wide t=x;
+    x=y;
+    y=t;
+  }
+  int32_t diff=x.exp-y.exp;
+  f128_wideShiftRightSticky(&y,diff>256?256:diff);
+  if(x.sign==y.sign){
+    uint64_t carry=0;
+    for(int i=0;i<4;i++){
+      uint64_t s=x.m[i]+carry;
+      carry=s<carry;
+      x.m[i]=s+y.m[i];
+      carry+=x.m[i]<s;
+    }
+  }else{
+    uint64_t borrow=0;
+    for(int i=0;i<4;i++){
+      uint64_t d=x.m[i]-borrow;
+      borrow=d>x.m[i];
+      x.m[i]=d-y.m[i];
+      borrow+=x.m[i]>d;
+    }
+    if(f128_wideIsZero(&x)){
+      x.sign=0;// x-x -> +0
+      return x;
+    }
+  }
+  f128_wideNormalize(&x);
+  return x;
+}
+// round normalized x to nearest f128
+static f128 f128_wideRound(f128_wide x){
+  if(f128_wideIsZero(&x))
+    return (f128){.hi=x.sign,.low=0};
+  // mantissa with guard bits: bits F128_WIDE_LEADING_BIT down to F128_WIDE_LEADING_BIT-115
+  uint64_t hi=x.m[3]>>10;
+  uint64_t low=(x.m[3]<<54)|(x.m[2]>>10);
+  low|=(x.m[0]|x.m[1]|(x.m[2]&0x3ff))!=0;
+  int32_t exp=x.exp+F128_WIDE_LEADING_BIT-F128_WIDE_POINT;
+  if(exp<1){// subnormal
+    f128_shiftRightSticky(&hi,&low,1-exp>128?128:1-exp);
+    exp=1;
+  }
+  return f128_roundPack(x.sign,exp,hi,low,F128_ROUND_NEAREST);
+}
+
+// x*y+z with a single rounding
+f128 f128_fma(f128 x,f128 y,f128 z){
+  int32_t expX=(x.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  int32_t expY=(y.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  int32_t expZ=(z.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  if(expX==F128_EXP_MASK||expY==F128_EXP_MASK){
+    // NaN or Infinity product
+    return F128_UNTRACED(f128_add)(F128_UNTRACED(f128_mult)(x,y),z);
+  }
+  if(expZ==F128_EXP_MASK){
+    // x*y is finite
+    return z;
+  }
+  if(((x.hi&~F128_HI_SIGN_FLAG)|x.low)==0||((y.hi&~F128_HI_SIGN_FLAG)|y.low)==0){
+    // exact zero product
+    return F128_UNTRACED(f128_add)(F128_UNTRACED(f128_mult)(x,y),z);
+  }
+  if(((z.hi&~F128_HI_SIGN_FLAG)|z.low)==0){
+    return f128_wideRound(f128_multWide(x,y));
+  }
+  return f128_wideRound(f128_wideAdd(f128_multWide(x,y),f128_unpackWide(z)));
+}
+static bool f128_isFinite(f128 x){
+  return ((x.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK)!=F128_EXP_MASK;
+}
+static bool f128_isZero(f128 x){
+  return ((x.hi&~F128_HI_SIGN_FLAG)|x.low)==0;
+}
+// a*b+c*d with a single rounding
+f128 f128_dot2(f128 a,f128 b,f128 c,f128 d){
+  bool finiteAB=f128_isFinite(a)&&f128_isFinite(b);
+  bool finiteCD=f128_isFinite(c)&&f128_isFinite(d);
+  if(!(finiteAB&&finiteCD)){
+    // NaN or Infinity product
+    if(finiteAB)
+      return F128_UNTRACED(f128_mult)(c,d);
+    if(finiteCD)
+      return F128_UNTRACED(f128_mult)(a,b);
+    return F128_UNTRACED(f128_add)(F128_UNTRACED(f128_mult)(a,b),F128_UNTRACED(f128_mult)(c,d));
+  }
+  bool zeroAB=f128_isZero(a)||f128_isZero(b);
+  bool zeroCD=f128_isZero(c)||f128_isZero(d);
+  if(zeroAB||zeroCD){
+    // exact zero product
+    if(!zeroAB)
+      return f128_wideRound(f128_multWide(a,b));
+    if(!zeroCD)
+      return f128_wideRound(f128_multWide(c,d));
+    return F128_UNTRACED(f128_add)(F128_UNTRACED(f128_mult)(a,b),F128_UNTRACED(f128_mult)(c,d));
+  }
+  return f128_wideRound(f128_wideAdd(f128_multWide(a,b),f128_multWide(c,d)));
+}
+
+// interleaved products
+// the products of up to F128_MULT_MAX_LANES independent pairs are computed step by step for all pairs,
+// such that the multiplications and carry chains of different pairs can execute in parallel
+
+#define F128_MULT_MAX_LANES 4
+
+// x[k]*y[k] for count<=F128_MULT_MAX_LANES pairs of normal numbers,
+// same result as f128_mult, results that are not normal are computed by f128_mult
+static inline void f128_multNormalLanes(const f128* x,const f128* y,f128* out,int count){
+  uint64_t p[F128_MULT_MAX_LANES][4];
+  int32_t exp[F128_MULT_MAX_LANES];
+  f128 res[F128_MULT_MAX_LANES];// out may alias x or y
+  // exact 226-bit products of the 113-bit mantissas
+  for(int k=0;k<count;k++){
+    uint64_t xHi=(x[k].hi&F128_HI_MANTISSA_MASK)|F128_HI_HIDDEN_BIT;
+    uint64_t yHi=(y[k].hi&F128_HI_MANTISSA_MASK)|F128_HI_HIDDEN_BIT;
+    uint64_t midHi0,midHi1;
+    p[k][0]=f128_mult64(x[k].low,y[k].low,&p[k][1]);
+    uint64_t mid0=f128_mult64(xHi,y[k].low,&midHi0);
+    uint64_t mid1=f128_mult64(x[k].low,yHi,&midHi1);
+    p[k][2]=f128_mult64(xHi,yHi,&p[k][3]);
+    p[k][1]+=mid0;
+    uint64_t carry=p[k][1]<mid0;
+    p[k][1]+=mid1;
+    carry+=p[k][1]<mid1;
+    p[k][2]+=midHi0+carry;
+    p[k][3]+=p[k][2]<midHi0+carry;
+    p[k][2]+=midHi1;
+    p[k][3]+=p[k][2]<midHi1;
+  }
+  // round to 113 bits, the leading bit is at position 224 or 225
+  for(int k=0;k<count;k++){
+    int s=(int)(p[k][3]>>(225-192));
+    uint64_t low=(p[k][1]>>(48+s))|(p[k][2]<<(16-s));
+    uint64_t hi=(p[k][2]>>(48+s))|(p[k][3]<<(16-s));
+    uint64_t round=(p[k][1]>>(47+s))&1;
+    uint64_t sticky=((p[k][1]&((1ull<<(47+s))-1))|p[k][0])!=0;
+    uint64_t up=round&(sticky|(low&1));
+    low+=up;
+    hi+=up&(low==0);
+    // rounding overflowed to 2^113, low is zero
+    int carry=(int)(hi>>(F128_HI_EXP_SHIFT+1));
+    hi>>=carry;
+    exp[k]=(int32_t)((x[k].hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK)+(int32_t)((y[k].hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK)
+      -(int32_t)F128_EXP_BIAS+s+carry;
+    res[k]=(f128){
+      .hi=((x[k].hi^y[k].hi)&F128_HI_SIGN_FLAG)|(((uint64_t)exp[k]&F128_EXP_MASK)<<F128_HI_EXP_SHIFT)|(hi&F128_HI_MANTISSA_MASK),
+      .low=low
+    };
+  }
+  for(int k=0;k<count;k++){
+    if(!f128_isNormalExp(exp[k])){// overflow or underflow
+      res[k]=f128_mult(x[k],y[k]);
+    }
+  }
+  for(int k=0;k<count;k++){
+    out[k]=res[k];
+  }
+}
+static inline void f128_multLanes(const f128* x,const f128* y,f128* out,int count){
+  bool normal=true;
+  for(int k=0;k<count;k++){
+    normal&=f128_isNormalExp((x[k].hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK);
+    normal&=f128_isNormalExp((y[k].hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK);
+  }
+  if(normal){
+    f128_multNormalLanes(x,y,out,count);
+    return;
+  }
+  for(int k=0;k<count;k++){
+    out[k]=f128_mult(x[k],y[k]);
+  }
+}
+// out[k]=x[k]*y[k] for 0 <= k < 2, out may be the same array as x or y
+void f128_mult2(const f128* x,const f128* y,f128* out){
+  f128_multLanes(x,y,out,2);
+}
+// out[k]=x[k]*y[k] for 0 <= k < 4, out may be the same array as x or y
+void f128_mult4(const f128* x,const f128* y,f128* out){
+  f128_multLanes(x,y,out,4);
+}
+
+// division and inverse with selectable accuracy
+// the relaxed modes seed the Newton iteration with the double precision inverse ( 52 correct bits )
+// instead of the linear estimate used by f128_inv ( 4 correct bits )
+
+typedef enum{
+  // same as f128_div and f128_inv: 5 Newton iterations, error up to a few ulp
+  F128_ACCURACY_FULL,
+  // error below 1 ulp ( faithfully rounded ) for normal operands:
+  // 1 Newton iteration followed by a correction step with the exact remainder
+  F128_ACCURACY_FAITHFUL,
+  // relative error below 2^-100 for normal operands: 1 Newton iteration
+  F128_ACCURACY_FAST
+}f128_accuracy;
+
+// inverse of 0.5<=x<1 with relative error below 2^-103
+static f128 f128_normalizedInvFast(f128 x){
+  f128 one=f128_fromF64(1);
+  f128 y=f128_fromF64(1/f128_toF64(x));
+  // iteration step: y2 = y1 + y1(1 - x * y1), 1 - x * y1 is computed exactly
+  return F128_UNTRACED(f128_add)(y,F128_UNTRACED(f128_mult)(y,F128_UNTRACED(f128_sub)(one,F128_UNTRACED(f128_mult)(x,y))));
+}
+// a-b*c for positive normal a,b,c with 0.5 <= b,c < 4 and a-b*c below 2^-96*a, rounded to double
+// the difference is computed exactly from the low 128 bits of the mantissa product
+static double f128_residual(f128 a,f128 b,f128 c){
+  int32_t expA=(a.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  int32_t expB=(b.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  int32_t expC=(c.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  // a and b*c as integers in units of the lowest bit of the product, modulo 2^128
+  int shift=expA-expB-expC+(int32_t)F128_EXP_BIAS+112-64;
+  uint64_t aHi=a.low<<shift;
+  uint64_t bHi=(b.hi&F128_HI_MANTISSA_MASK)|F128_HI_HIDDEN_BIT;
+  uint64_t cHi=(c.hi&F128_HI_MANTISSA_MASK)|F128_HI_HIDDEN_BIT;
+  uint64_t productHi;
+  uint64_t productLow=f128_mult64(b.low,c.low,&productHi);
+  productHi+=bHi*c.low+b.low*cHi;
+  // the difference fits in a signed 128-bit integer
+  uint64_t low=0-productLow;
+  uint64_t hi=aHi-productHi-(productLow!=0);
+  bool negative=(hi&I64_HI_BIT)!=0;
+  if(negative){
+    low=~low+1;
+    hi=~hi+(low==0);
+  }
+  // unit of the lowest bit of b*c
+  double unit=(f64_bits){.i64=((uint64_t)(expB+expC-2*(int32_t)F128_EXP_BIAS-224+F64_EXP_BIAS))<<F64_EXP_SHIFT}.f64;
+  double r=((double)hi*0x1p64+(double)low)*unit;
+  return negative?-r:r;
+}
+// x/y for normal x and y
+static f128 f128_divRelaxed(f128 x,f128 y,f128_accuracy accuracy){
+  uint64_t sign=(x.hi&F128_HI_SIGN_FLAG)^(y.hi&F128_HI_SIGN_FLAG);
+  int32_t expX=(x.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  int32_t expY=(y.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  // scale x such that 1 <= x < 2 and y such that 0.5 <= y < 1, the quotient cannot over- or underflow
+  x.hi=(x.hi&F128_HI_MANTISSA_MASK)|(F128_EXP_BIAS<<F128_HI_EXP_SHIFT);
+  y.hi=(y.hi&F128_HI_MANTISSA_MASK)|((F128_EXP_BIAS-1)<<F128_HI_EXP_SHIFT);
+  f128 inv=f128_normalizedInvFast(y);
+  f128 q=F128_UNTRACED(f128_mult)(x,inv);
+  if(accuracy==F128_ACCURACY_FAITHFUL){
+    // the correction (x - q * y) / y is far below 1 ulp of q, double precision is sufficient
+    q=F128_UNTRACED(f128_add)(q,f128_fromF64(f128_residual(x,q,y)/f128_toF64(y)));
+  }
+  q.hi|=sign;
+  return f128_ldexp(q,expX-expY-1);
+}
+// 1/x for normal x
+static f128 f128_invRelaxed(f128 x,f128_accuracy accuracy){
+  uint64_t sign=x.hi&F128_HI_SIGN_FLAG;
+  int32_t expX=(x.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  // scale x such that 0.5 <= x < 1
+  x.hi=(x.hi&F128_HI_MANTISSA_MASK)|((F128_EXP_BIAS-1)<<F128_HI_EXP_SHIFT);
+  f128 y=f128_normalizedInvFast(x);
+  if(accuracy==F128_ACCURACY_FAITHFUL){
+    // iteration step with the exact remainder 1 - x * y, the correction is far below 1 ulp of y
+    y=F128_UNTRACED(f128_add)(y,f128_fromF64(f128_residual(f128_fromF64(1),x,y)*f128_toF64(y)));
+  }
+  y.hi|=sign;
+  return f128_ldexp(y,(int32_t)F128_EXP_BIAS-1-expX);
+}
+
+// operands that are not normal ( zero, subnormal, Infinity, NaN ) use the full accuracy path
+f128 f128_divAccuracy(f128 x,f128 y,f128_accuracy accuracy){
+  int32_t expX=(x.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  int32_t expY=(y.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  if(accuracy==F128_ACCURACY_FULL||!(f128_isNormalExp(expX)&f128_isNormalExp(expY)))
+    return F128_UNTRACED(f128_div)(x,y);
+  return f128_divRelaxed(x,y,accuracy);
+}
+f128 f128_invAccuracy(f128 x,f128_accuracy accuracy){
+  int32_t expX=(x.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  if(accuracy==F128_ACCURACY_FULL||!f128_isNormalExp(expX))
+    return F128_UNTRACED(f128_inv)(x);
+  return f128_invRelaxed(x,accuracy);
+}
+void f128_divArrayAccuracy(const f128* x,const f128* y,f128* out,size_t count,f128_accuracy accuracy){
+  for(size_t i=0;i<count;i++){
+    out[i]=f128_divAccuracy(x[i],y[i],accuracy);
+  }
+}
+void f128_invArrayAccuracy(const f128* values,f128* out,size_t count,f128_accuracy accuracy){
+  for(size_t i=0;i<count;i++){
+    out[i]=f128_invAccuracy(values[i],accuracy);
+  }
+}
+
+// interval arithmetic
+// the lower bound is rounded down and the upper bound is rounded up, such that the interval contains the exact result,
+// both bounds of an endpoint result are rounded from the same unrounded value, so every result is computed only once
+// intervals containing NaN give the interval [NaN,NaN]
+
+typedef struct{
+  f128 lo;
+  f128 hi;
+}f128_interval;
+
+static bool f128_isNormal(f128 x){
+  return f128_isNormalExp((x.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK);
+}
+static f128_interval f128_intervalNaN(void){
+  f128 nan=(f128){.hi=F128_NAN_HI,.low=F128_NAN_LOW};
+  return (f128_interval){.lo=nan,.hi=nan};
+}
+static bool f128_intervalIsPoint(f128_interval x){
+  return x.lo.hi==x.hi.hi&&x.lo.low==x.hi.low;
+}
+f128_interval f128_intervalPoint(f128 x){
+  return (f128_interval){.lo=x,.hi=x};
+}
+f128_interval f128_intervalAdd(f128_interval x,f128_interval y){
+  if(f128_intervalIsPoint(x)&&f128_intervalIsPoint(y)&&f128_isNormal(x.lo)&&f128_isNormal(y.lo)){
+    f128_unrounded r=f128_addNormalUnrounded(x.lo,y.lo);
+    return (f128_interval){.lo=f128_packUnrounded(r,F128_ROUND_DOWN),.hi=f128_packUnrounded(r,F128_ROUND_UP)};
+  }
+  f128_interval r={.lo=f128_addDown(x.lo,y.lo),.hi=f128_addUp(x.hi,y.hi)};
+  if(f128_isNaN(r.lo)||f128_isNaN(r.hi))
+    return f128_intervalNaN();
+  return r;
+}
+f128_interval f128_intervalSub(f128_interval x,f128_interval y){
+  y=(f128_interval){.lo=y.hi,.hi=y.lo};
+  y.lo.hi^=F128_HI_SIGN_FLAG;
+  y.hi.hi^=F128_HI_SIGN_FLAG;
+  return f128_intervalAdd(x,y);
+}
+// lower and upper bound of x*y
+static void f128_intervalProduct(f128 x,f128 y,f128* lo,f128* hi){
+  if(f128_isNormal(x)&&f128_isNormal(y)){
+    f128_unrounded r=f128_multNormalUnrounded(x,y);
+    *lo=f128_packUnrounded(r,F128_ROUND_DOWN);
+    *hi=f128_packUnrounded(r,F128_ROUND_UP);
+    return;
+  }
+  if((f128_isZero(x)&&!f128_isFinite(y)&&!f128_isNaN(y))||(f128_isZero(y)&&!f128_isFinite(x)&&!f128_isNaN(x))){
+    // an endpoint 0 times an unbounded endpoint, the products of the interior points are 0 or tend to 0
+    *lo=*hi=(f128){.hi=(x.hi^y.hi)&F128_HI_SIGN_FLAG,.low=0};
+    return;
+  }
+  *lo=f128_multSpecial(x,y,F128_ROUND_DOWN);
+  *hi=f128_multSpecial(x,y,F128_ROUND_UP);
+}
+// endpoint products 0*Infinity are treated as 0 ( [0,1]*[1,Infinity] = [0,Infinity] ), NaN endpoints give [NaN,NaN]
+f128_interval f128_intervalMult(f128_interval x,f128_interval y){
+  f128 lo[4],hi[4];
+  // products of all pairs of endpoints, pairs of equal endpoints are only computed once
+  int n=0;
+  for(int i=0;i<2;i++){
+    if(i==1&&f128_intervalIsPoint(x))
+      break;
+    for(int j=0;j<2;j++){
+      if(j==1&&f128_intervalIsPoint(y))
+        break;
+      f128_intervalProduct(i?x.hi:x.lo,j?y.hi:y.lo,&lo[n],&hi[n]);
+      if(f128_isNaN(lo[n])) // NaN operand
+        return f128_intervalNaN();
+      n++;
+    }
+  }
+  f128_interval r={.lo=lo[0],.hi=hi[0]};
+  for(int k=1;k<n;k++){
+    if(f128_compare(lo[k],r.lo)<0)
+      r.lo=lo[k];
+    if(f128_compare(hi[k],r.hi)>0)
+      r.hi=hi[k];
+  }
+  return r;
+}
+
+// compression codec for f128 columns
+// Gorilla-style: every value is stored as XOR with its predecessor,
+// the non-zero bits of the XOR are stored as window [leading zeros, length]
+// blocks of F128_XOR_BLOCK_SIZE values start at a word boundary with a raw value
+// to allow random access by block
+
+#define F128_XOR_BLOCK_SIZE 256
+
+typedef struct{
+  uint64_t* words;
+  size_t capacity;// size of words in 64-bit words
+  size_t bitPos;// number of bits written
+  size_t* blockOffsets;// word offset of each block, may be NULL
+  size_t count;// number of values written
+  f128 prev;
+  int prevLeading;
+  int prevLength;
+}f128_xorEncoder;
+
+static int f128_leadingZeros64(uint64_t x){
+  if(x==0)
+    return 64;
+  int n=0;
+  if((x&0xffffffff00000000ull)==0){
+    n+=32;x<<=32;
+  }
+  if((x&0xffff000000000000ull)==0){
+    n+=16;x<<=16;
+  }
+  if((x&0xff00000000000000ull)==0){
+    n+=8;x<<=8;
+  }
+  if((x&0xf000000000000000ull)==0){
+    n+=4;x<<=4;
+  }
+  if((x&0xc000000000000000ull)==0){
+    n+=2;x<<=2;
+  }
+  if((x&0x8000000000000000ull)==0){
+    n+=1;
+  }
+  return n;
+}
+static int f128_trailingZeros64(uint64_t x){
+  if(x==0)
+    return 64;
+  return 63-f128_leadingZeros64(x&-x);
+}
+
+// append the n (<=64) lowest bits of value, returns false if the buffer is full
+static bool f128_writeBits(uint64_t* words,size_t capacity,size_t* bitPos,uint64_t value,int n){
+  if(n==0)
+    return true;
+  size_t pos=*bitPos;
+  size_t word=pos>>6;
+  int free=64-(int)(pos&63);
+  if(((pos+n+63)>>6)>capacity)
+    return false;
+  if(n<64)
+    value&=(1ull<<n)-1;
+  if(free==64)
+    words[word]=0;
+  if(n<=free){
+    words[word]|=value<<(free-n);
+  }else{
+    words[word]|=value>>(n-free);
+    words[word+1]=value<<(64-(n-free));
+  }
+  *bitPos=pos+n;
+  return true;
+}
+// read the next n (<=64) bits
+static uint64_t f128_readBits(const uint64_t* words,size_t* bitPos,int n){
+  if(n==0)
+    return 0;
+  size_t pos=*bitPos;
+  size_t word=pos>>6;
+  int avail=64-(int)(pos&63);
+  uint64_t res=(words[word]<<(64-avail))>>(64-n);
+  if(n>avail){
+    res|=words[word+1]>>(64-(n-avail));
+  }
+  *bitPos=pos+n;
+  return res;
+}
+
+void f128_xorEncoderInit(f128_xorEncoder* enc,uint64_t* words,size_t capacity,size_t* blockOffsets){
+  enc->words=words;
+  enc->capacity=capacity;
+  enc->bitPos=0;
+  enc->blockOffsets=blockOffsets;
+  enc->count=0;
+  enc->prev=(f128){.hi=0,.low=0};
+  enc->prevLeading=0;
+  enc->prevLength=0;
+}
+// clears the bits written after the last encoded value, such that the encoder is unchanged when a write fails
+static void f128_xorEncodeRollback(f128_xorEncoder* enc){
+  size_t pos=enc->bitPos;
+  int used=(int)(pos&63);
+  if(used!=0&&(pos>>6)<enc->capacity)
+    enc->words[pos>>6]&=~(I64_MAX>>used);
+}
+// appends x, returns false if the buffer is full,
+// the encoder is not changed in that case and x can be encoded again after increasing the capacity
+bool f128_xorEncode(f128_xorEncoder* enc,f128 x){
+  size_t pos=enc->bitPos;
+  int prevLeading=enc->prevLeading;
+  int prevLength=enc->prevLength;
+  bool ok=true;
+  if(enc->count%F128_XOR_BLOCK_SIZE==0){
+    // start of block: align to word boundary and store raw value
+    pos=(pos+63)&~(size_t)63;
+    ok=f128_writeBits(enc->words,enc->capacity,&pos,x.hi,64)&&
+       f128_writeBits(enc->words,enc->capacity,&pos,x.low,64);
+    prevLeading=0;
+    prevLength=0;
+  }else{
+    uint64_t hi=x.hi^enc->prev.hi;
+    uint64_t low=x.low^enc->prev.low;
+    if((hi|low)==0){
+      ok=f128_writeBits(enc->words,enc->capacity,&pos,0,1);
+    }else{
+      int leading=hi?f128_leadingZeros64(hi):64+f128_leadingZeros64(low);
+      int trailing=low?f128_trailingZeros64(low):64+f128_trailingZeros64(hi);
+      int length=128-leading-trailing;
+      if(prevLength>0&&leading>=prevLeading&&
+          leading+length<=prevLeading+prevLength){
+        // reuse previous window
+        trailing=128-prevLeading-prevLength;
+        length=prevLength;
+        ok=f128_writeBits(enc->words,enc->capacity,&pos,2,2);
+      }else{
+        ok=f128_writeBits(enc->words,enc->capacity,&pos,3,2)&&
+           f128_writeBits(enc->words,enc->capacity,&pos,leading,7)&&
+           f128_writeBits(enc->words,enc->capacity,&pos,length-1,7);
+        prevLeading=leading;
+        prevLength=length;
+      }
+      // shift meaningful bits to bottom
+      if(trailing>=64){
+        low=hi>>(trailing-64);
+        hi=0;
+      }else if(trailing>0){
+        low=(low>>trailing)|(hi<<(64-trailing));
+        hi>>=trailing;
+      }
+      if(length>64){
+        ok=ok&&f128_writeBits(enc->words,enc->capacity,&pos,hi,length-64)&&
+           f128_writeBits(enc->words,enc->capacity,&pos,low,64);
+      }else{
+        ok=ok&&f128_writeBits(enc->words,enc->capacity,&pos,low,length);
+      }
+    }
+  }
+  if(!ok){
+    f128_xorEncodeRollback(enc);
+    return false;
+  }
+  if(enc->count%F128_XOR_BLOCK_SIZE==0&&enc->blockOffsets!=NULL)
+    enc->blockOffsets[enc->count/F128_XOR_BLOCK_SIZE]=(pos>>6)-2;
+  enc->bitPos=pos;
+  enc->prev=x;
+  enc->prevLeading=prevLeading;
+  enc->prevLength=prevLength;
+  enc->count++;
+  return true;
+}
+size_t f128_xorEncoderSize(const f128_xorEncoder* enc){
+  return (enc->bitPos+63)>>6;
+}
+// decode count values, words has to point to the start of a block
+void f128_xorDecode(const uint64_t* words,size_t count,f128* out){
+  size_t pos=0;
+  f128 prev={.hi=0,.low=0};
+  int leading=0,length=0;
+  for(size_t i=0;i<count;i++){
+    if(i%F128_XOR_BLOCK_SIZE==0){
+      pos=(pos+63)&~(size_t)63;
+      prev.hi=words[pos>>6];
+      prev.low=words[(pos>>6)+1];
+      pos+=128;
+      out[i]=prev;
+      continue;
+    }
+    if(f128_readBits(words,&pos,1)){
+      if(f128_readBits(words,&pos,1)){
+        leading=(int)f128_readBits(words,&pos,7);
+        length=(int)f128_readBits(words,&pos,7)+1;
+      }
+      uint64_t hi=0,low;
+      if(length>64){
+        hi=f128_readBits(words,&pos,length-64);
+        low=f128_readBits(words,&pos,64);
+      }else{
+        low=f128_readBits(words,&pos,length);
+      }
+      int trailing=128-leading-length;
+      if(trailing>=64){
+        hi=low<<(trailing-64);
+        low=0;
+      }else if(trailing>0){
+        hi=(hi<<trailing)|(low>>(64-trailing));
+        low<<=trailing;
+      }
+      prev.hi^=hi;
+      prev.low^=low;
+    }
+    out[i]=prev;
+  }
+}
+
+// uniformly distributed value in [0,1) from 128 random bits (e.g. from i128_pcgNext)
+// the bits are interpreted as fixed point number bits*2^-128 truncated to 113 significant bits,
+// values above 2^-16 keep the full precision of the mantissa
+f128 f128_uniform(uint64_t hi,uint64_t low){
+  if((hi|low)==0){
+    return (f128){.hi=0,.low=0};
+  }
+  int shift=hi?f128_leadingZeros64(hi):64+f128_leadingZeros64(low);
+  // shift highest set bit to position 127
+  if(shift>=64){
+    hi=low<<(shift-64);
+    low=0;
+  }else if(shift>0){
+    hi=(hi<<shift)|(low>>(64-shift));
+    low<<=shift;
+  }
+  uint64_t exp=F128_EXP_BIAS-1-shift;
+  return (f128){
+    .hi=(exp<<F128_HI_EXP_SHIFT)|((hi>>15)&F128_HI_MANTISSA_MASK),
+    .low=(hi<<49)|(low>>15)
+  };
+}
+// converts an array of random bits (e.g. from i128_pcgFill) to uniform values in place
+void f128_uniformArray(f128* values,size_t count){
+  for(size_t i=0;i<count;i++){
+    values[i]=f128_uniform(values[i].hi,values[i].low);
+  }
+}
+
+// complex numbers
+// products use f128_dot2, each component is rounded once
+
+c128 c128_add(c128 x,c128 y){
+  return (c128){
+    .re=F128_UNTRACED(f128_add)(x.re,y.re),
+    .im=F128_UNTRACED(f128_add)(x.im,y.im)
+  };
+}
+c128 c128_sub(c128 x,c128 y){
+  return (c128){
+    .re=F128_UNTRACED(f128_sub)(x.re,y.re),
+    .im=F128_UNTRACED(f128_sub)(x.im,y.im)
+  };
+}
+c128 c128_mult(c128 x,c128 y){
+  f128 negIm=x.im;
+  negIm.hi^=F128_HI_SIGN_FLAG;
+  return (c128){
+    .re=f128_dot2(x.re,y.re,negIm,y.im),
+    .im=f128_dot2(x.re,y.im,x.im,y.re)
+  };
+}
+
+// fast fourier transform of power of two size
+
+// 2*pi rounded to nearest
+#define F128_2PI_HI  0x4001921fb54442d1ull
+#define F128_2PI_LOW 0x8469898cc51701b8ull
+
+// number of taylor terms used for angles |x| <= pi/4, the last term is below 2^-113
+#define F128_TAYLOR_TERMS 20
+
+// reciprocals of the taylor coefficients -1/((2i-1)*(2i)) and -1/((2i)*(2i+1))
+static void f128_cosSinCoefficients(f128* cosCoef,f128* sinCoef){
+  f128 one=f128_fromF64(1);
+  for(int i=1;i<=F128_TAYLOR_TERMS;i++){
+    f128 d[2]={f128_fromF64(-(2*i-1)*(2*i)),f128_fromF64(-(2*i)*(2*i+1))};
+    f128* coef[2]={&cosCoef[i-1],&sinCoef[i-1]};
+    for(int k=0;k<2;k++){
+      // refine result of division with one newton step
+      f128 y=F128_UNTRACED(f128_div)(one,d[k]);
+      f128 negY=y;
+      negY.hi^=F128_HI_SIGN_FLAG;
+      *coef[k]=f128_fma(f128_fma(negY,d[k],one),y,y);
+    }
+  }
+}
+// cos(2*pi*k/n) and sin(2*pi*k/n) for 0 <= k/n <= 1/8 using the taylor series
+static void f128_cosSinTurn(size_t k,size_t n,const f128* cosCoef,const f128* sinCoef,f128* c,f128* s){
+  f128 one=f128_fromF64(1);
+  if(k==0){
+    *c=one;
+    *s=(f128){.hi=0,.low=0};
+    return;
+  }
+  // k/n is exact for n power of two
+  f128 x=F128_UNTRACED(f128_mult)(f128_fromF64((double)k),f128_fromF64(1.0/(double)n));
+  x=F128_UNTRACED(f128_mult)(x,(f128){.hi=F128_2PI_HI,.low=F128_2PI_LOW});
+  f128 x2=F128_UNTRACED(f128_mult)(x,x);
+  // horner scheme starting with smallest terms
+  f128 cosSum=one,sinSum=one;
+  for(int i=F128_TAYLOR_TERMS-1;i>=0;i--){
+    cosSum=f128_fma(F128_UNTRACED(f128_mult)(x2,cosCoef[i]),cosSum,one);
+    sinSum=f128_fma(F128_UNTRACED(f128_mult)(x2,sinCoef[i]),sinSum,one);
+  }
+  *c=cosSum;
+  *s=F128_UNTRACED(f128_mult)(sinSum,x);
+}
+// exp(-2*pi*i*k/n) for 0 <= k < n/2
+static c128 c128_twiddle(size_t k,size_t n,const f128* cosCoef,const f128* sinCoef){
+  f128 c,s;
+  bool rotate=false;
+  if(4*k>n){// exp(-i(pi/2+x)) = -i exp(-ix)
+    k-=n/4;
+    rotate=true;
+  }
+  if(8*k<=n){
+    f128_cosSinTurn(k,n,cosCoef,sinCoef,&c,&s);
+  }else{// cos(pi/2-x) = sin(x)
+    f128_cosSinTurn(n/4-k,n,cosCoef,sinCoef,&s,&c);
+  }
+  s.hi^=F128_HI_SIGN_FLAG;
+  if(rotate){
+    // -i(c+is) = s-ic
+    c.hi^=F128_HI_SIGN_FLAG;
+    return (c128){.re=s,.im=c};
+  }
+  return (c128){.re=c,.im=s};
+}
+
+// prepare transforms of size n, returns false if n is not a power of two or memory allocation failed
+bool c128_fftPlanInit(c128_fftPlan* plan,size_t n){
+  plan->n=n;
+  plan->twiddles=NULL;
+  if(n==0||(n&(n-1))!=0)
+    return false;
+  if(n<2)
+    return true;
+  plan->twiddles=malloc(n/2*sizeof(c128));
+  if(plan->twiddles==NULL)
+    return false;
+  f128 cosCoef[F128_TAYLOR_TERMS],sinCoef[F128_TAYLOR_TERMS];
+  f128_cosSinCoefficients(cosCoef,sinCoef);
+  for(size_t k=0;k<n/2;k++){
+    plan->twiddles[k]=c128_twiddle(k,n,cosCoef,sinCoef);
+  }
+  return true;
+}
+void c128_fftPlanFree(c128_fftPlan* plan){
+  free(plan->twiddles);
+  plan->twiddles=NULL;
+}
+// in place transform, the inverse transform is scaled by 1/n
+void c128_fft(const c128_fftPlan* plan,c128* data,bool inverse){
+  size_t n=plan->n;
+  // bit reversal permutation
+  for(size_t i=1,j=0;i<n;i++){
+    size_t bit=n>>1;
+    for(;j&bit;bit>>=1)
+      j^=bit;
+    j^=bit;
+    if(i<j){
+      c128 t=data[i];
+      data[i]=data[j];
+      data[j]=t;
+    }
+  }
+  // radix-2 butterflies
+  for(size_t len=2;len<=n;len<<=1){
+    size_t half=len>>1,step=n/len;
+    for(size_t start=0;start<n;start+=len){
+      // k=0: multiplication with 1
+      c128 u=data[start],v=data[start+half];
+      data[start]=c128_add(u,v);
+      data[start+half]=c128_sub(u,v);
+      for(size_t k=1;k<half;k++){
+        c128 w=plan->twiddles[k*step];
+        if(inverse){
+          w.im.hi^=F128_HI_SIGN_FLAG;
+        }
+        u=data[start+k];
+        v=c128_mult(data[start+k+half],w);
+        data[start+k]=c128_add(u,v);
+        data[start+k+half]=c128_sub(u,v);
+      }
+    }
+  }
+  if(inverse&&n>1){
+    f128 scale=f128_fromF64(1.0/(double)n);
+    for(size_t i=0;i<n;i++){
+      data[i].re=F128_UNTRACED(f128_mult)(data[i].re,scale);
+      data[i].im=F128_UNTRACED(f128_mult)(data[i].im,scale);
+    }
+  }
+}
+void c128_fftOutOfPlace(const c128_fftPlan* plan,const c128* in,c128* out,bool inverse){
+  if(in!=out){
+    memcpy(out,in,plan->n*sizeof(c128));
+  }
+  c128_fft(plan,out,inverse);
+}
+// count transforms stored consecutively in data
+void c128_fftBatch(const c128_fftPlan* plan,c128* data,size_t count,bool inverse){
+  for(size_t i=0;i<count;i++){
+    c128_fft(plan,data+i*plan->n,inverse);
+  }
+}
+
+// O(n^2) discrete fourier transform with the twiddle factors of plan, reference for c128_fftBenchmark
+static void c128_naiveDft(const c128_fftPlan* plan,const c128* in,c128* out){
+  size_t n=plan->n;
+  for(size_t k=0;k<n;k++){
+    c128 sum=in[0];
+    for(size_t j=1;j<n;j++){
+      // exp(-2*pi*i*jk/n), exp(-2*pi*i*(m+n/2)/n) = -exp(-2*pi*i*m/n)
+      size_t m=(j*k)&(n-1);
+      c128 w;
+      if(m<n/2){
+        w=plan->twiddles[m];
+      }else{
+        w=plan->twiddles[m-n/2];
+        w.re.hi^=F128_HI_SIGN_FLAG;
+        w.im.hi^=F128_HI_SIGN_FLAG;
+      }
+      sum=c128_add(sum,c128_mult(in[j],w));
+    }
+    out[k]=sum;
+  }
+}
+// seconds per call of the fft ( or the naive dft ) of in, repeated until at least 0.1s have passed
+static double c128_timeTransform(const c128_fftPlan* plan,const c128* in,c128* out,bool naive){
+  size_t calls=0;
+  clock_t start=clock(),elapsed;
+  do{
+    if(naive){
+      c128_naiveDft(plan,in,out);
+    }else{
+      c128_fftOutOfPlace(plan,in,out,false);
+    }
+    calls++;
+    elapsed=clock()-start;
+  }while(elapsed<CLOCKS_PER_SEC/10);
+  return (double)elapsed/CLOCKS_PER_SEC/(double)calls;
+}
+// time per transform of c128_fft and the O(n^2) dft for all powers of two from 2 to maxN,
+// and the largest difference of the results relative to the largest component of the dft
+bool c128_fftBenchmark(size_t maxN,FILE* out){
+  c128* data=malloc(3*maxN*sizeof(c128));
+  if(data==NULL)
+    return false;
+  uint64_t state=0x9e3779b97f4a7c15ull;
+  for(size_t i=0;i<maxN;i++){
+    f128* parts[2]={&data[i].re,&data[i].im};
+    for(int k=0;k<2;k++){
+      uint64_t bits[2];
+      for(int b=0;b<2;b++){
+        state^=state<<13;
+        state^=state>>7;
+        state^=state<<17;
+        bits[b]=state;
+      }
+      *parts[k]=f128_uniform(bits[0],bits[1]);
+    }
+  }
+  c128 *fftOut=data+maxN,*dftOut=data+2*maxN;
+  fprintf(out,"%8s %14s %14s %9s %10s\n","n","fft ns/call","dft ns/call","speedup","max diff");
+  for(size_t n=2;n<=maxN;n<<=1){
+    c128_fftPlan plan;
+    if(!c128_fftPlanInit(&plan,n)){
+      free(data);
+      return false;
+    }
+    double fftSeconds=c128_timeTransform(&plan,data,fftOut,false);
+    double dftSeconds=c128_timeTransform(&plan,data,dftOut,true);
+    double maxDiff=0,maxAbs=0;
+    for(size_t i=0;i<n;i++){
+      c128 d=c128_sub(fftOut[i],dftOut[i]);
+      double v[4]={f128_toF64(d.re),f128_toF64(d.im),f128_toF64(dftOut[i].re),f128_toF64(dftOut[i].im)};
+      for(int k=0;k<4;k++){
+        v[k]=v[k]<0?-v[k]:v[k];
+      }
+      maxDiff=v[0]>maxDiff?v[0]:maxDiff;
+      maxDiff=v[1]>maxDiff?v[1]:maxDiff;
+      maxAbs=v[2]>maxAbs?v[2]:maxAbs;
+      maxAbs=v[3]>maxAbs?v[3]:maxAbs;
+    }
+    fprintf(out,"%8zu %14.0f %14.0f %9.1f %10.2g\n",n,fftSeconds*1e9,dftSeconds*1e9,
+      fftSeconds>0?dftSeconds/fftSeconds:0.0,maxAbs>0?maxDiff/maxAbs:0.0);
+    c128_fftPlanFree(&plan);
+  }
+  free(data);
+  return true;
+}
+
+// linear systems
+
+// refinement stops when |b-a*x| <= n*2^F128_REFINE_TOLERANCE_EXP*|a|*|x|
+#define F128_REFINE_TOLERANCE_EXP -112
+
+// LU decomposition with partial pivoting in double precision, lu is overwritten with the factors,
+// row k was swapped with row pivot[k], returns false if the matrix is singular
+static bool f128_luDecompose(size_t n,double* lu,size_t* pivot){
+  for(size_t k=0;k<n;k++){
+    size_t p=k;
+    double max=0;
+    for(size_t i=k;i<n;i++){
+      double v=lu[i*n+k]<0?-lu[i*n+k]:lu[i*n+k];
+      if(v>max){
+        max=v;
+        p=i;
+      }
+    }
+    if(max==0)
+      return false;
+    pivot[k]=p;
+    if(p!=k){
+      for(size_t j=0;j<n;j++){
+        double t=lu[k*n+j];
+        lu[k*n+j]=lu[p*n+j];
+        lu[p*n+j]=t;
+      }
+    }
+    double inv=1/lu[k*n+k];
+    for(size_t i=k+1;i<n;i++){
+      double l=lu[i*n+k]*=inv;
+      for(size_t j=k+1;j<n;j++){
+        lu[i*n+j]-=l*lu[k*n+j];
+      }
+    }
+  }
+  return true;
+}
+// solves lu*x=b in place
+static void f128_luSolve(size_t n,const double* lu,const size_t* pivot,double* x){
+  for(size_t k=0;k<n;k++){
+    double t=x[k];
+    x[k]=x[pivot[k]];
+    x[pivot[k]]=t;
+  }
+  for(size_t i=1;i<n;i++){
+    for(size_t j=0;j<i;j++){
+      x[i]-=lu[i*n+j]*x[j];
+    }
+  }
+  for(size_t i=n;i-->0;){
+    for(size_t j=i+1;j<n;j++){
+      x[i]-=lu[i*n+j]*x[j];
+    }
+    x[i]/=lu[i*n+i];
+  }
+}
+// iterative refinement of x using the double precision factorization of a,
+// stores number of correction steps in iterations
+// |x| ( for x not NaN )
+static f128 f128_abs(f128 x){
+  x.hi&=~F128_HI_SIGN_FLAG;
+  return x;
+}
+static f128 f128_maxAbs(f128 max,f128 x){
+  x=f128_abs(x);
+  return f128_compare(x,max)>0?x:max;
+}
+// the norms and the convergence test are computed in f128 since the products can be outside the range of double,
+// the residuals are scaled by a power of two before they are converted to double for the correction
+static bool f128_refine(size_t n,const f128* a,const f128* b,f128* x,const double* lu,const size_t* pivot,f128* r,double* d,int maxIterations,int* iterations){
+  f128 zero={.hi=0,.low=0};
+  // infinity norm of a
+  f128 aNorm=zero;
+  for(size_t i=0;i<n;i++){
+    f128 sum=zero;
+    for(size_t j=0;j<n;j++){
+      sum=F128_UNTRACED(f128_add)(sum,f128_abs(a[i*n+j]));
+    }
+    aNorm=f128_maxAbs(aNorm,sum);
+  }
+  // n*F128_REFINE_TOLERANCE*|a|
+  f128 tolerance=F128_UNTRACED(f128_mult)(f128_ldexp(f128_fromF64((double)n),F128_REFINE_TOLERANCE_EXP),aNorm);
+  for(int k=0;;k++){
+    // residual with one rounding per term
+    f128 rNorm=zero,xNorm=zero;
+    for(size_t i=0;i<n;i++){
+      r[i]=b[i];
+      for(size_t j=0;j<n;j++){
+        f128 aij=a[i*n+j];
+        aij.hi^=F128_HI_SIGN_FLAG;
+        r[i]=f128_fma(aij,x[j],r[i]);
+      }
+      rNorm=f128_maxAbs(rNorm,r[i]);
+      xNorm=f128_maxAbs(xNorm,x[i]);
+    }
+    // backward error at the level of f128 rounding errors
+    if(f128_compare(rNorm,F128_UNTRACED(f128_mult)(tolerance,xNorm))<=0){
+      *iterations=k;
+      return true;
+    }
+    if(k==maxIterations){
+      *iterations=k;
+      return false;
+    }
+    // largest residual scaled to [0.5,1)
+    int scale;
+    f128_frexp(rNorm,&scale);
+    for(size_t i=0;i<n;i++){
+      d[i]=f128_toF64(f128_ldexp(r[i],-scale));
+    }
+    f128_luSolve(n,lu,pivot,d);
+    for(size_t i=0;i<n;i++){
+      x[i]=F128_UNTRACED(f128_add)(x[i],f128_ldexp(f128_fromF64(d[i]),scale));
+    }
+  }
+}
+// solves a*x=b for a n x n matrix a ( row major ):
+// factorizes a in double precision, then refines the solution using residuals b-a*x computed in f128
+// until the residual is at the level of f128 rounding errors
+// returns false if a is singular in double precision, memory allocation failed
+// or the refinement did not converge within maxIterations steps ( x then contains the last iterate ),
+// the number of refinement steps is stored in iterations (if not NULL)
+bool f128_solve(size_t n,const f128* a,const f128* b,f128* x,int maxIterations,int* iterations){
+  if(iterations!=NULL){
+    *iterations=0;
+  }
+  if(n==0)
+    return true;
+  double* lu=malloc(n*n*sizeof(double));
+  double* d=malloc(n*sizeof(double));
+  f128* r=malloc(n*sizeof(f128));
+  size_t* pivot=calloc(n,sizeof(size_t));
+  bool converged=false;
+  int k=0;
+  if(lu!=NULL&&d!=NULL&&r!=NULL&&pivot!=NULL){
+    for(size_t i=0;i<n*n;i++){
+      lu[i]=f128_toF64(a[i]);
+    }
+    if(f128_luDecompose(n,lu,pivot)){
+      for(size_t i=0;i<n;i++){
+        d[i]=f128_toF64(b[i]);
+      }
+      f128_luSolve(n,lu,pivot,d);
+      for(size_t i=0;i<n;i++){
+        x[i]=f128_fromF64(d[i]);
+      }
+      converged=f128_refine(n,a,b,x,lu,pivot,r,d,maxIterations,&k);
+    }
+  }
+  if(iterations!=NULL){
+    *iterations=k;
+  }
+  free(lu);
+  free(d);
+  free(r);
+  free(pivot);
+  return converged;
+}
+
+// polynomial evaluation
+
+// enough levels of x^(2^k) for any number of coefficients that fits in memory
+#define F128_POLY_MAX_LEVELS 64
+
+// polynomial c[0]+c[1]*x+...+c[count-1]*x^(count-1) prepared for evaluation
+typedef struct{
+  size_t count;
+  f128* coefficients;
+  f128_wide* unpacked;// unpacked coefficients, NULL if a coefficient is NaN or infinite
+}f128_poly;
+
+// copies coefficients and unpacks them,
+// returns false if count is zero or memory allocation failed
+bool f128_polyInit(f128_poly* p,const f128* coefficients,size_t count){
+  p->count=count;
+  p->coefficients=NULL;
+  p->unpacked=NULL;
+  if(count==0)
+    return false;
+  p->coefficients=malloc(count*sizeof(f128));
+  if(p->coefficients==NULL)
+    return false;
+  memcpy(p->coefficients,coefficients,count*sizeof(f128));
+  bool finite=true;
+  for(size_t i=0;i<count;i++){
+    finite&=f128_isFinite(coefficients[i]);
+  }
+  if(finite){
+    p->unpacked=malloc(count*sizeof(f128_wide));
+    if(p->unpacked==NULL){
+      free(p->coefficients);
+      p->coefficients=NULL;
+      return false;
+    }
+    for(size_t i=0;i<count;i++){
+      p->unpacked[i]=f128_unpackWide(coefficients[i]);
+    }
+  }
+  return true;
+}
+void f128_polyFree(f128_poly* p){
+  free(p->coefficients);
+  free(p->unpacked);
+  p->coefficients=NULL;
+  p->unpacked=NULL;
+}
+// Estrin's scheme: the lower half and the upper half of the coefficients
+// are evaluated independently and combined by one fma, powers[k] is x^(2^k),
+// uses unpacked coefficients cw and unpacked x xw if they are not NULL
+static f128 f128_estrin(const f128* c,const f128_wide* cw,size_t count,const f128* powers,const f128_wide* xw){
+  if(count==1)
+    return c[0];
+  if(count==2){
+    // zero products go through f128_fma to get the sign of zero results right
+    if(cw!=NULL&&!f128_isZero(c[1]))
+      return f128_wideRound(f128_wideAdd(f128_multUnpacked(cw+1,xw),cw[0]));
+    return f128_fma(c[1],powers[0],c[0]);
+  }
+  // split at largest power of two below count
+  int k=0;
+  while((size_t)2<<k<count)
+    k++;
+  size_t half=(size_t)1<<k;
+  f128 low=f128_estrin(c,cw,half,powers,xw);
+  f128 high=f128_estrin(c+half,cw==NULL?NULL:cw+half,count-half,powers,xw);
+  return f128_fma(high,powers[k],low);
+}
+// fills powers with x^(2^k) for all k needed to evaluate count coefficients
+static void f128_estrinPowers(f128 x,size_t count,f128* powers){
+  powers[0]=x;
+  for(int k=1;((size_t)1<<k)<count;k++){
+    powers[k]=F128_UNTRACED(f128_mult)(powers[k-1],powers[k-1]);
+  }
+}
+static f128 f128_polyEvalPowers(const f128_poly* p,const f128* powers){
+  if(p->unpacked==NULL||!f128_isFinite(powers[0])||f128_isZero(powers[0]))
+    return f128_estrin(p->coefficients,NULL,p->count,powers,NULL);
+  f128_wide xw=f128_unpackWide(powers[0]);
+  return f128_estrin(p->coefficients,p->unpacked,p->count,powers,&xw);
+}
+// value of polynomial at x, every step is a fused multiply-add
+f128 f128_polyEval(const f128_poly* p,f128 x){
+  f128 powers[F128_POLY_MAX_LEVELS];
+  f128_estrinPowers(x,p->count,powers);
+  return f128_polyEvalPowers(p,powers);
+}
+void f128_polyEvalArray(const f128_poly* p,const f128* x,f128* out,size_t count){
+  for(size_t i=0;i<count;i++){
+    out[i]=f128_polyEval(p,x[i]);
+  }
+}
+// p(x)/q(x) with a single division, powers of x are shared by both polynomials
+f128 f128_rationalEval(const f128_poly* p,const f128_poly* q,f128 x){
+  f128 powers[F128_POLY_MAX_LEVELS];
+  f128_estrinPowers(x,p->count>q->count?p->count:q->count,powers);
+  return F128_UNTRACED(f128_div)(f128_polyEvalPowers(p,powers),f128_polyEvalPowers(q,powers));
+}
+void f128_rationalEvalArray(const f128_poly* p,const f128_poly* q,const f128* x,f128* out,size_t count){
+  for(size_t i=0;i<count;i++){
+    out[i]=f128_rationalEval(p,q,x[i]);
+  }
+}
+
+// rounding and decomposition, implemented by manipulating mantissa and exponent bits
+
+typedef enum{
+  F128_INTEGRAL_TRUNC,
+  F128_INTEGRAL_FLOOR,
+  F128_INTEGRAL_CEIL,
+  F128_INTEGRAL_ROUND,// ties away from zero
+  F128_INTEGRAL_NEAREST// ties to even
+}f128_integralMode;
+
+// rounds x to an integral value by clearing the fractional bits of the mantissa
+static f128 f128_integral(f128 x,f128_integralMode mode){
+  int32_t exp=(x.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  int32_t e=exp-(int32_t)F128_EXP_BIAS;
+  if(exp==F128_EXP_MASK||e>=112||f128_isZero(x))
+    return x;// NaN, Infinity or already integral
+  uint64_t sign=x.hi&F128_HI_SIGN_FLAG;
+  if(e<0){
+    // |x|<1, result is 0 or 1
+    bool one;
+    switch(mode){
+      case F128_INTEGRAL_FLOOR:
+        one=sign!=0;
+        break;
+      case F128_INTEGRAL_CEIL:
+        one=sign==0;
+        break;
+      case F128_INTEGRAL_ROUND:
+        one=e==-1;
+        break;
+      case F128_INTEGRAL_NEAREST:
+        one=e==-1&&((x.hi&F128_HI_MANTISSA_MASK)|x.low)!=0;
+        break;
+      default:
+        one=false;
+    }
+    return (f128){.hi=sign|(one?F128_EXP_BIAS<<F128_HI_EXP_SHIFT:0),.low=0};
+  }
+  // the lowest 112-e bits of the mantissa are fractional
+  int f=112-e;
+  uint64_t maskHi=f>64?(1ull<<(f-64))-1:0;
+  uint64_t maskLow=f>=64?I64_MAX:(1ull<<f)-1;
+  uint64_t fracHi=x.hi&maskHi,fracLow=x.low&maskLow;
+  if((fracHi|fracLow)==0)
+    return x;
+  uint64_t halfHi=f>64?1ull<<(f-65):0,halfLow=f>64?0:1ull<<(f-1);
+  int c=fracHi!=halfHi?(fracHi>halfHi?1:-1):fracLow!=halfLow?(fracLow>halfLow?1:-1):0;
+  bool up;
+  switch(mode){
+    case F128_INTEGRAL_FLOOR:
+      up=sign!=0;
+      break;
+    case F128_INTEGRAL_CEIL:
+      up=sign==0;
+      break;
+    case F128_INTEGRAL_ROUND:
+      up=c>=0;
+      break;
+    case F128_INTEGRAL_NEAREST:
+      // for f=112 the integral part is the hidden bit, which is odd
+      up=c>0||(c==0&&(f==112||(f>=64?(x.hi>>(f-64)):(x.low>>f))&1));
+      break;
+    default:
+      up=false;
+  }
+  x.hi&=~maskHi;
+  x.low&=~maskLow;
+  if(up){
+    // add one unit of the last integral bit, a carry into the exponent gives the correct power of two
+    if(f>=64){
+      x.hi+=1ull<<(f-64);
+    }else{
+      x.low+=1ull<<f;
+      x.hi+=x.low==0;
+    }
+  }
+  return x;
+}
+// round toward zero
+f128 f128_trunc(f128 x){
+  return f128_integral(x,F128_INTEGRAL_TRUNC);
+}
+// round toward -Infinity
+f128 f128_floor(f128 x){
+  return f128_integral(x,F128_INTEGRAL_FLOOR);
+}
+// round toward +Infinity
+f128 f128_ceil(f128 x){
+  return f128_integral(x,F128_INTEGRAL_CEIL);
+}
+// round to nearest integer, ties away from zero
+f128 f128_round(f128 x){
+  return f128_integral(x,F128_INTEGRAL_ROUND);
+}
+// round to nearest integer, ties to even
+f128 f128_nearbyint(f128 x){
+  return f128_integral(x,F128_INTEGRAL_NEAREST);
+}
+// splits x in integral part (stored in integral) and fractional part (returned),
+// both have the same sign as x
+f128 f128_modf(f128 x,f128* integral){
+  *integral=f128_trunc(x);
+  if(f128_isNaN(x))
+    return x;
+  if(!f128_isFinite(x))
+    return (f128){.hi=x.hi&F128_HI_SIGN_FLAG,.low=0};
+  f128 r=F128_UNTRACED(f128_sub)(x,*integral);// exact
+  r.hi=(r.hi&~F128_HI_SIGN_FLAG)|(x.hi&F128_HI_SIGN_FLAG);
+  return r;
+}
+// splits x in mantissa in [0.5,1) and power of two (stored in exp)
+f128 f128_frexp(f128 x,int* exp){
+  int32_t e=(x.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  if(e==F128_EXP_MASK||f128_isZero(x)){
+    *exp=0;
+    return x;
+  }
+  uint64_t sign=x.hi&F128_HI_SIGN_FLAG;
+  if(e==0){
+    e=1-f128_normalizeMantissa(&x);
+  }
+  *exp=e-(int32_t)F128_EXP_BIAS+1;
+  return (f128){
+    .hi=sign|((F128_EXP_BIAS-1)<<F128_HI_EXP_SHIFT)|(x.hi&F128_HI_MANTISSA_MASK),
+    .low=x.low
+  };
+}
+// x*2^n, only the exponent is changed unless the result is subnormal
+f128 f128_ldexp(f128 x,int n){
+  int32_t exp=(x.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  if(exp==F128_EXP_MASK||f128_isZero(x))
+    return x;
+  uint64_t sign=x.hi&F128_HI_SIGN_FLAG;
+  if(exp==0){
+    exp=1-f128_normalizeMantissa(&x);
+  }
+  // large shifts over- or underflow in any case, limit them to avoid integer overflow
+  int32_t limit=2*F128_EXP_MASK;
+  exp+=n>limit?limit:n<-limit?-limit:n;
+  if(exp>=(int32_t)F128_EXP_MASK)
+    return (f128){.hi=sign|F128_INF_HI,.low=F128_INF_LOW};
+  if(exp>=1)
+    return (f128){.hi=sign|((uint64_t)exp<<F128_HI_EXP_SHIFT)|(x.hi&F128_HI_MANTISSA_MASK),.low=x.low};
+  // subnormal result
+  uint64_t hi=((x.hi&F128_HI_MANTISSA_MASK)|F128_HI_HIDDEN_BIT)<<F128_GUARD_BITS|(x.low>>(64-F128_GUARD_BITS));
+  uint64_t low=x.low<<F128_GUARD_BITS;
+  f128_shiftRightSticky(&hi,&low,1-exp>128?128:1-exp);
+  return f128_roundPack(sign,1,hi,low,F128_ROUND_NEAREST);
+}
+// same as f128_ldexp
+f128 f128_scalbn(f128 x,int n){
+  return f128_ldexp(x,n);
+}
+// packs exact value m*2^(exp-F128_EXP_BIAS-112) with m < 2^113 and exp>=1
+static f128 f128_packExact(uint64_t sign,int32_t exp,uint64_t hi,uint64_t low){
+  if((hi|low)==0)
+    return (f128){.hi=sign,.low=0};
+  // shift highest bit to hidden bit, as far as exponent allows
+  int shift=hi!=0?f128_leadingZeros64(hi)-15:49+f128_leadingZeros64(low);
+  if(shift>exp-1){
+    shift=exp-1;
+  }
+  if(shift>=64){
+    hi=low<<(shift-64);
+    low=0;
+  }else if(shift>0){
+    hi=(hi<<shift)|(low>>(64-shift));
+    low<<=shift;
+  }
+  exp-=shift;
+  if((hi&F128_HI_HIDDEN_BIT)==0){
+    exp=0;// subnormal
+  }
+  return (f128){.hi=sign|((uint64_t)exp<<F128_HI_EXP_SHIFT)|(hi&F128_HI_MANTISSA_MASK),.low=low};
+}
+// x-n*y, where n is x/y rounded toward zero or to nearest (ties to even), the result is exact
+// computed by long division of the mantissas
+static f128 f128_remainderExact(f128 x,f128 y,bool nearest){
+  int32_t expX=(x.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  int32_t expY=(y.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  if(f128_isNaN(x))
+    return x;
+  if(f128_isNaN(y))
+    return y;
+  if(expX==F128_EXP_MASK||f128_isZero(y))
+    return (f128){.hi=F128_NAN_HI,.low=F128_NAN_LOW};
+  if(expY==F128_EXP_MASK||f128_isZero(x))
+    return x;
+  uint64_t sign=x.hi&F128_HI_SIGN_FLAG;
+  // integer mantissas, value is m*2^(exp-F128_EXP_BIAS-112)
+  uint64_t xHi=x.hi&F128_HI_MANTISSA_MASK,yHi=y.hi&F128_HI_MANTISSA_MASK;
+  if(expX==0){
+    expX=1;
+  }else{
+    xHi|=F128_HI_HIDDEN_BIT;
+  }
+  if(expY==0){
+    expY=1;
+  }else{
+    yHi|=F128_HI_HIDDEN_BIT;
+  }
+  uint64_t rHi,rLow;
+  if(expX<expY){
+    // |x|<|y|, the quotient is zero
+    if(!nearest||expX<expY-1)
+      return x;
+    // 2|x|>|y| iff mx>my, then the result is |x|-|y| in units of 2^expX
+    if(xHi<yHi||(xHi==yHi&&x.low<=y.low))
+      return x;
+    rLow=(y.low<<1)-x.low;
+    rHi=((yHi<<1)|(y.low>>63))-xHi-((y.low<<1)<x.low);
+    return f128_packExact(sign^F128_HI_SIGN_FLAG,expX,rHi,rLow);
+  }
+  // long division of mx*2^(expX-expY) by my, one quotient bit per step
+  rHi=rLow=0;
+  bool odd=false;
+  for(int32_t i=112+expX-expY;i>=0;i--){
+    uint64_t bit=0;
+    if(i>=expX-expY){
+      int k=i-(expX-expY);
+      bit=(k>=64?xHi>>(k-64):x.low>>k)&1;
+    }
+    rHi=(rHi<<1)|(rLow>>63);
+    rLow=(rLow<<1)|bit;
+    odd=rHi>yHi||(rHi==yHi&&rLow>=y.low);
+    if(odd){
+      rHi-=yHi+(rLow<y.low);
+      rLow-=y.low;
+    }
+  }
+  if(nearest){
+    // compare 2r with my
+    uint64_t r2Hi=(rHi<<1)|(rLow>>63),r2Low=rLow<<1;
+    if(r2Hi>yHi||(r2Hi==yHi&&(r2Low>y.low||(r2Low==y.low&&odd)))){
+      rHi=yHi-rHi-(y.low<rLow);
+      rLow=y.low-rLow;
+      sign^=F128_HI_SIGN_FLAG;
+    }
+  }
+  return f128_packExact(sign,expY,rHi,rLow);
+}
+// x-n*y with n=trunc(x/y), result has the sign of x
+f128 f128_fmod(f128 x,f128 y){
+  return f128_remainderExact(x,y,false);
+}
+// x-n*y with n=x/y rounded to nearest (ties to even)
+f128 f128_remainder(f128 x,f128 y){
+  return f128_remainderExact(x,y,true);
+}
+static void f128_integralArray(const f128* values,f128* out,size_t count,f128_integralMode mode){
+  for(size_t i=0;i<count;i++){
+    out[i]=f128_integral(values[i],mode);
+  }
+}
+void f128_truncArray(const f128* values,f128* out,size_t count){
+  f128_integralArray(values,out,count,F128_INTEGRAL_TRUNC);
+}
+void f128_floorArray(const f128* values,f128* out,size_t count){
+  f128_integralArray(values,out,count,F128_INTEGRAL_FLOOR);
+}
+void f128_ceilArray(const f128* values,f128* out,size_t count){
+  f128_integralArray(values,out,count,F128_INTEGRAL_CEIL);
+}
+void f128_roundArray(const f128* values,f128* out,size_t count){
+  f128_integralArray(values,out,count,F128_INTEGRAL_ROUND);
+}
+void f128_nearbyintArray(const f128* values,f128* out,size_t count){
+  f128_integralArray(values,out,count,F128_INTEGRAL_NEAREST);
+}
+void f128_ldexpArray(const f128* values,f128* out,size_t count,int n){
+  for(size_t i=0;i<count;i++){
+    out[i]=f128_ldexp(values[i],n);
+  }
+}
+// out[i]=fmod(x[i],y)
+void f128_fmodArray(const f128* x,f128 y,f128* out,size_t count){
+  for(size_t i=0;i<count;i++){
+    out[i]=f128_fmod(x[i],y);
+  }
+}
+
+// double-double numbers
+// a value is the unevaluated sum hi+low of two doubles with |low| <= ulp(hi)/2, giving about 106 bits of precision,
+// the operations only use hardware floating point operations and are much faster than the f128 operations
+// the error-free transformations require IEEE double arithmetic without extended intermediate precision
+// ( FLT_EVAL_METHOD 0, e.g. SSE2 ) and break when compiled with -ffast-math
+// the exponent range is the one of double, f128 values outside that range are converted to 0 or Infinity,
+// the splitting in products overflows for operands above 2^996
+
+typedef struct{
+  double hi;
+  double low;
+}dd128;
+
+// a+b=s+err exactly
+static inline double dd128_twoSum(double a,double b,double* err){
+  double s=a+b;
+  double bb=s-a;
+  *err=(a-(s-bb))+(b-bb);
+  return s;
+}
+// a+b=s+err exactly, requires |a| >= |b|
+static inline double dd128_quickTwoSum(double a,double b,double* err){
+  double s=a+b;
+  *err=b-(s-a);
+  return s;
+}
+// Dekker's split: a=hi+low where hi and low have at most 26 significant bits
+static inline void dd128_split(double a,double* hi,double* low){
+  double t=134217729.0*a;// 2^27+1
+  *hi=t-(t-a);
+  *low=a-*hi;
+}
+// a*b=p+err exactly ( without overflow or underflow )
+static inline double dd128_twoProd(double a,double b,double* err){
+  double p=a*b;
+  double aHi,aLow,bHi,bLow;
+  dd128_split(a,&aHi,&aLow);
+  dd128_split(b,&bHi,&bLow);
+  *err=((aHi*bHi-p)+aHi*bLow+aLow*bHi)+aLow*bLow;
+  return p;
+}
+static inline dd128 dd128_renormalize(double hi,double low){
+  double err;
+  hi=dd128_quickTwoSum(hi,low,&err);
+  return (dd128){.hi=hi,.low=err};
+}
+
+dd128 dd128_fromF64(double x){
+  return (dd128){.hi=x,.low=0};
+}
+// x rounded to nearest double-double, hi is x rounded to nearest double and low is the remainder rounded to nearest double
+dd128 dd128_fromF128(f128 x){
+  double hi=f128_toF64(x);
+  if(hi-hi!=0)// Infinity or NaN
+    return (dd128){.hi=hi,.low=0};
+  // x-hi is exact
+  return (dd128){.hi=hi,.low=f128_toF64(F128_UNTRACED(f128_sub)(x,f128_fromF64(hi)))};
+}
+// the exact value hi+low rounded to nearest f128, exact if the bits of hi and low fit in the f128 mantissa
+f128 dd128_toF128(dd128 x){
+  return F128_UNTRACED(f128_add)(f128_fromF64(x.hi),f128_fromF64(x.low));
+}
+double dd128_toF64(dd128 x){
+  return x.hi+x.low;
+}
+
+// the arithmetic is implemented in inline functions such that division and square root
+// do not depend on the compiler inlining the public functions
+static inline dd128 dd128_sum(dd128 x,dd128 y){
+  double e,f;
+  double s=dd128_twoSum(x.hi,y.hi,&e);
+  double t=dd128_twoSum(x.low,y.low,&f);
+  e+=t;
+  s=dd128_quickTwoSum(s,e,&e);
+  e+=f;
+  return dd128_renormalize(s,e);
+}
+static inline dd128 dd128_product(dd128 x,dd128 y){
+  double e;
+  double p=dd128_twoProd(x.hi,y.hi,&e);
+  e+=x.hi*y.low+x.low*y.hi;
+  return dd128_renormalize(p,e);
+}
+// relative error below 2^-104
+dd128 dd128_add(dd128 x,dd128 y){
+  return dd128_sum(x,y);
+}
+dd128 dd128_sub(dd128 x,dd128 y){
+  return dd128_sum(x,(dd128){.hi=-y.hi,.low=-y.low});
+}
+// relative error below 2^-103
+dd128 dd128_mult(dd128 x,dd128 y){
+  return dd128_product(x,y);
+}
+// x*y+z, the product is not rounded to a double-double before the addition,
+// error below 2^-103*(|x*y|+|z|)
+dd128 dd128_fma(dd128 x,dd128 y,dd128 z){
+  double e,f;
+  double p=dd128_twoProd(x.hi,y.hi,&e);
+  e+=x.hi*y.low+x.low*y.hi;
+  double s=dd128_twoSum(p,z.hi,&f);
+  double t=dd128_twoSum(e,z.low,&e);
+  f+=t;
+  s=dd128_quickTwoSum(s,f,&f);
+  f+=e;
+  return dd128_renormalize(s,f);
+}
+// long division with three partial quotients, relative error below 2^-104
+dd128 dd128_div(dd128 x,dd128 y){
+  double q1=x.hi/y.hi;
+  dd128 r=dd128_sum(x,dd128_product((dd128){.hi=-q1,.low=0},y));
+  double q2=r.hi/y.hi;
+  r=dd128_sum(r,dd128_product((dd128){.hi=-q2,.low=0},y));
+  double q3=r.hi/y.hi;
+  double e;
+  q1=dd128_quickTwoSum(q1,q2,&e);
+  return dd128_sum((dd128){.hi=q1,.low=e},(dd128){.hi=q3,.low=0});
+}
+// 1/sqrt(x) for positive normal x by Newton iteration from an estimate computed on the bit representation
+static double dd128_invSqrt64(double x){
+  // halving the exponent gives a relative error below 2^-4
+  double y=(f64_bits){.i64=0x5fe6eb50c7b537a9ull-((f64_bits){.f64=x}.i64>>1)}.f64;
+  // every step doubles the number of correct bits
+  for(int i=0;i<4;i++){
+    y*=1.5-0.5*x*y*y;
+  }
+  return y;
+}
+// square root without libm: the double estimate s=x/sqrt(x) is corrected by (x-s*s)/(2*s) ( Karp's method ),
+// relative error below 2^-102
+dd128 dd128_sqrt(dd128 x){
+  if(x.hi<=0){
+    if(x.hi==0)
+      return x;// sqrt(+-0) -> +-0
+    // sqrt(negative) -> NaN
+    return (dd128){.hi=(f64_bits){.i64=((uint64_t)F64_EXP_MASK<<F64_EXP_SHIFT)|(F64_HIDDEN_BIT>>1)}.f64,.low=0};
+  }
+  if(x.hi-x.hi!=0)// Infinity or NaN
+    return x;
+  // scale subnormal or huge values into a range where x*y*y does not overflow or underflow
+  int scale=0;
+  if(x.hi<0x1p-900){
+    x=(dd128){.hi=x.hi*0x1p1000,.low=x.low*0x1p1000};
+    scale=-500;
+  }else if(x.hi>0x1p900){
+    x=(dd128){.hi=x.hi*0x1p-1000,.low=x.low*0x1p-1000};
+    scale=500;
+  }
+  double y=dd128_invSqrt64(x.hi);
+  double s=x.hi*y;
+  double e;
+  double sq=dd128_twoProd(s,s,&e);
+  dd128 r=dd128_sum(x,(dd128){.hi=-sq,.low=-e});
+  dd128 res=dd128_renormalize(s,r.hi*y*0.5);
+  if(scale!=0){
+    double factor=scale>0?0x1p500:0x1p-500;
+    res=(dd128){.hi=res.hi*factor,.low=res.low*factor};
+  }
+  return res;
+}
+
+// batch operations, plain loops without branches that the compiler can vectorize
+void dd128_addArray(const dd128* x,const dd128* y,dd128* out,size_t count){
+  for(size_t i=0;i<count;i++){
+    out[i]=dd128_add(x[i],y[i]);
+  }
+}
+void dd128_subArray(const dd128* x,const dd128* y,dd128* out,size_t count){
+  for(size_t i=0;i<count;i++){
+    out[i]=dd128_sub(x[i],y[i]);
+  }
+}
+void dd128_multArray(const dd128* x,const dd128* y,dd128* out,size_t count){
+  for(size_t i=0;i<count;i++){
+    out[i]=dd128_mult(x[i],y[i]);
+  }
+}
+void dd128_divArray(const dd128* x,const dd128* y,dd128* out,size_t count){
+  for(size_t i=0;i<count;i++){
+    out[i]=dd128_div(x[i],y[i]);
+  }
+}
+void dd128_fromF128Array(const f128* values,dd128* out,size_t count){
+  for(size_t i=0;i<count;i++){
+    out[i]=dd128_fromF128(values[i]);
+  }
+}
+void dd128_toF128Array(const dd128* values,f128* out,size_t count){
+  for(size_t i=0;i<count;i++){
+    out[i]=dd128_toF128(values[i]);
+  }
+}
+
+// largest relative error |a-b|/|b| as power of two
+static int dd128_relErrorExp(f128 a,f128 b,int maxExp){
+  f128 err=F128_UNTRACED(f128_div)(F128_UNTRACED(f128_sub)(a,b),b);
+  int32_t exp=(err.hi>>F128_HI_EXP_SHIFT)&F128_EXP_MASK;
+  if(exp==0)// zero or below 2^-16382
+    return maxExp;
+  exp-=F128_EXP_BIAS-1;// |err| < 2^exp
+  return exp>maxExp?exp:maxExp;
+}
+typedef enum{
+  DD128_BENCH_ADD,
+  DD128_BENCH_SUB,
+  DD128_BENCH_MULT,
+  DD128_BENCH_DIV,
+  DD128_BENCH_FMA,
+  DD128_BENCH_SQRT,
+  DD128_BENCH_COUNT
+}dd128_benchOp;
+static const char* dd128_benchNames[DD128_BENCH_COUNT]={"add","sub","mult","div","fma","sqrt"};
+// times each operation for count random operands in f128 and in double-double,
+// prints time per operation and the largest relative error of the double-double results,
+// the f128 results are the reference ( f128 has no square root, its error is checked by squaring )
+// returns false if memory allocation failed
+bool dd128_benchmark(size_t count,FILE* out){
+  f128* f=malloc(4*count*sizeof(f128));
+  dd128* d=malloc(4*count*sizeof(dd128));
+  if(f==NULL||d==NULL){
+    free(f);
+    free(d);
+    return false;
+  }
+  f128 *fx=f,*fy=f+count,*fz=f+2*count,*fr=f+3*count;
+  dd128 *dx=d,*dy=d+count,*dz=d+2*count,*dr=d+3*count;
+  uint64_t state=0x9e3779b97f4a7c15ull;
+  for(size_t i=0;i<3*count;i++){
+    // xorshift for random mantissa bits, values in [1,2)*2^[-20,20) with random sign
+    uint64_t bits[2];
+    for(int k=0;k<2;k++){
+      state^=state<<13;
+      state^=state>>7;
+      state^=state<<17;
+      bits[k]=state;
+    }
+    f128 v=F128_UNTRACED(f128_add)(f128_fromF64(1),f128_uniform(bits[0],bits[1]));
+    v=f128_ldexp(v,(int)(bits[0]%40)-20);
+    v.hi|=bits[1]&F128_HI_SIGN_FLAG;
+    // use the same values in both representations
+    d[i]=dd128_fromF128(v);
+    f[i]=dd128_toF128(d[i]);
+  }
+  // touch result arrays before timing
+  memset(fr,0,count*sizeof(f128));
+  memset(dr,0,count*sizeof(dd128));
+  fprintf(out,"op   f128 ns/op  dd128 ns/op  speedup  max relative error\n");
+  for(int op=0;op<DD128_BENCH_COUNT;op++){
+    clock_t start=clock();
+    switch((dd128_benchOp)op){
+      case DD128_BENCH_ADD:f128_addArray(fx,fy,fr,count);break;
+      case DD128_BENCH_SUB:f128_subArray(fx,fy,fr,count);break;
+      case DD128_BENCH_MULT:f128_multArray(fx,fy,fr,count);break;
+      case DD128_BENCH_DIV:f128_divArray(fx,fy,fr,count);break;
+      case DD128_BENCH_FMA:
+        for(size_t i=0;i<count;i++){
+          fr[i]=f128_fma(fx[i],fy[i],fz[i]);
+        }
+        break;
+      case DD128_BENCH_SQRT:
+      case DD128_BENCH_COUNT:
+        break;
+    }
+    double f128Seconds=(double)(clock()-start)/CLOCKS_PER_SEC;
+    start=clock();
+    switch((dd128_benchOp)op){
+      case DD128_BENCH_ADD:dd128_addArray(dx,dy,dr,count);break;
+      case DD128_BENCH_SUB:dd128_subArray(dx,dy,dr,count);break;
+      case DD128_BENCH_MULT:dd128_multArray(dx,dy,dr,count);break;
+      case DD128_BENCH_DIV:dd128_divArray(dx,dy,dr,count);break;
+      case DD128_BENCH_FMA:
+        for(size_t i=0;i<count;i++){
+          dr[i]=dd128_fma(dx[i],dy[i],dz[i]);
+        }
+        break;
+      case DD128_BENCH_SQRT:
+        for(size_t i=0;i<count;i++){
+          dr[i]=dd128_sqrt((dd128){.hi=dx[i].hi<0?-dx[i].hi:dx[i].hi,.low=dx[i].hi<0?-dx[i].low:dx[i].low});
+        }
+        break;
+      case DD128_BENCH_COUNT:
+        break;
+    }
+    double dd128Seconds=(double)(clock()-start)/CLOCKS_PER_SEC;
+    int errExp=-1000;
+    for(size_t i=0;i<count;i++){
+      f128 result=dd128_toF128(dr[i]);
+      if(op==DD128_BENCH_SQRT){
+        // sqrt(x)*(1+e) squared is x*(1+2e)
+        f128 x=fx[i];
+        x.hi&=~F128_HI_SIGN_FLAG;
+        int sqrErrExp=dd128_relErrorExp(F128_UNTRACED(f128_mult)(result,result),x,-1000)-1;
+        errExp=sqrErrExp>errExp?sqrErrExp:errExp;
+      }else{
+        errExp=dd128_relErrorExp(result,fr[i],errExp);
+      }
+    }
+    if(op==DD128_BENCH_SQRT){
+      fprintf(out,"%-4s %11s %12.1f %8s  2^%d\n",dd128_benchNames[op],"-",dd128Seconds*1e9/(double)count,"-",errExp);
+    }else{
+      fprintf(out,"%-4s %11.1f %12.1f %8.1f  2^%d\n",dd128_benchNames[op],f128Seconds*1e9/(double)count,
+        dd128Seconds*1e9/(double)count,dd128Seconds>0?f128Seconds/dd128Seconds:0.0,errExp);
+    }
+  }
+  free(f);
+  free(d);
+  return true;
+}
+
+// streaming moments
+// the samples are grouped in blocks of F128_MOMENTS_BLOCK_SIZE consecutive samples at fixed positions of the stream,
+// within a block the deviations from the first sample of the block are summed in double-double
+// ( in f128 once a deviation is outside the range where double-double products are accurate ),
+// the blocks are combined with Chan's formulas in f128 along the fixed binary tree over the block positions,
+// so the result does not depend on how the stream is split into chunks or accumulators
+
+#define F128_MOMENTS_BLOCK_SIZE 1024
+// tree nodes covering any range of less than 2^64 blocks
+#define F128_MOMENTS_MAX_NODES 128
+
+// number of samples, means, sums of squared deviations from the mean and sum of products of the deviations
+typedef struct{
+  uint64_t count;
+  f128 meanX;
+  f128 meanY;
+  f128 m2X;
+  f128 m2Y;
+  f128 cXY;
+}f128_moments;
+
+// moments of the blocks index*2^level to (index+1)*2^level-1
+typedef struct{
+  uint64_t index;
+  int level;
+  f128_moments moments;
+}f128_momentsNode;
+
+// sums of the deviations from the first sample of the current block
+typedef struct{
+  uint64_t count;
+  bool wide;// sums are stored in f128
+  f128 shiftX;
+  f128 shiftY;
+  dd128 sumX,sumY,sumXX,sumYY,sumXY;
+  f128 wideSumX,wideSumY,wideSumXX,wideSumYY,wideSumXY;
+}f128_momentsBlock;
+
+// accumulator for the samples starting at block firstBlock of the stream,
+// the nodes are the maximal tree nodes covering the complete blocks ( ordered by position )
+typedef struct{
+  uint64_t firstBlock;
+  uint64_t blocks;// number of complete blocks
+  size_t nodeCount;
+  f128_momentsNode nodes[F128_MOMENTS_MAX_NODES];
+  f128_momentsBlock block;
+}f128_momentsAccumulator;
+
+static f128 f128_fromU64(uint64_t n){
+  return f128_packExact(0,F128_EXP_BIAS+112,0,n);
+}
+// Chan's formulas for the union of the samples of a and b
+static f128_moments f128_momentsCombine(f128_moments a,f128_moments b){
+  if(a.count==0)
+    return b;
+  if(b.count==0)
+    return a;
+  f128_moments r={.count=a.count+b.count};
+  f128 n=f128_fromU64(r.count);
+  f128 fractionB=F128_UNTRACED(f128_div)(f128_fromU64(b.count),n);
+  // nA*nB/n
+  f128 weight=F128_UNTRACED(f128_mult)(f128_fromU64(a.count),fractionB);
+  f128 deltaX=F128_UNTRACED(f128_sub)(b.meanX,a.meanX);
+  f128 deltaY=F128_UNTRACED(f128_sub)(b.meanY,a.meanY);
+  r.meanX=F128_UNTRACED(f128_add)(a.meanX,F128_UNTRACED(f128_mult)(deltaX,fractionB));
+  r.meanY=F128_UNTRACED(f128_add)(a.meanY,F128_UNTRACED(f128_mult)(deltaY,fractionB));
+  r.m2X=F128_UNTRACED(f128_add)(F128_UNTRACED(f128_add)(a.m2X,b.m2X),F128_UNTRACED(f128_mult)(F128_UNTRACED(f128_mult)(deltaX,deltaX),weight));
+  r.m2Y=F128_UNTRACED(f128_add)(F128_UNTRACED(f128_add)(a.m2Y,b.m2Y),F128_UNTRACED(f128_mult)(F128_UNTRACED(f128_mult)(deltaY,deltaY),weight));
+  r.cXY=F128_UNTRACED(f128_add)(F128_UNTRACED(f128_add)(a.cXY,b.cXY),F128_UNTRACED(f128_mult)(F128_UNTRACED(f128_mult)(deltaX,deltaY),weight));
+  return r;
+}
+// moments from the shifted sums of a block: mean=shift+sum/n, m2=sumSquares-sum^2/n
+static f128_moments f128_momentsOfBlock(const f128_momentsBlock* block){
+  f128_moments r={.count=block->count};
+  if(block->count==0)
+    return r;
+  f128 sumX=block->wideSumX,sumY=block->wideSumY,sumXX=block->wideSumXX,sumYY=block->wideSumYY,sumXY=block->wideSumXY;
+  if(!block->wide){
+    sumX=dd128_toF128(block->sumX);
+    sumY=dd128_toF128(block->sumY);
+    sumXX=dd128_toF128(block->sumXX);
+    sumYY=dd128_toF128(block->sumYY);
+    sumXY=dd128_toF128(block->sumXY);
+  }
+  f128 n=f128_fromU64(block->count);
+  f128 meanDevX=F128_UNTRACED(f128_div)(sumX,n);
+  f128 meanDevY=F128_UNTRACED(f128_div)(sumY,n);
+  r.meanX=F128_UNTRACED(f128_add)(block->shiftX,meanDevX);
+  r.meanY=F128_UNTRACED(f128_add)(block->shiftY,meanDevY);
+  r.m2X=F128_UNTRACED(f128_sub)(sumXX,F128_UNTRACED(f128_mult)(sumX,meanDevX));
+  r.m2Y=F128_UNTRACED(f128_sub)(sumYY,F128_UNTRACED(f128_mult)(sumY,meanDevY));
+  r.cXY=F128_UNTRACED(f128_sub)(sumXY,F128_UNTRACED(f128_mult)(sumX,meanDevY));
+  return r;
+}
+// squares of deviations in [2^-450,2^450] and their sums stay in the normal range of double
+static bool f128_momentsInDDRange(double d){
+  if(d<0)
+    d=-d;
+  return d==0||(d>=0x1p-450&&d<=0x1p450);
+}
+// sum+d with absolute error below 2^-104*(|sum|+|d|), the low parts are added without correction
+// which shortens the dependency chain of the sums compared to dd128_sum
+static inline dd128 f128_momentsAccumulate(dd128 sum,dd128 d){
+  double e;
+  double s=dd128_twoSum(sum.hi,d.hi,&e);
+  e+=sum.low+d.low;
+  return dd128_renormalize(s,e);
+}
+// continue the sums of the block in f128
+static void f128_momentsWiden(f128_momentsBlock* block){
+  block->wide=true;
+  block->wideSumX=dd128_toF128(block->sumX);
+  block->wideSumY=dd128_toF128(block->sumY);
+  block->wideSumXX=dd128_toF128(block->sumXX);
+  block->wideSumYY=dd128_toF128(block->sumYY);
+  block->wideSumXY=dd128_toF128(block->sumXY);
+}
+// add deviations dx and dy of one sample, wideX and wideY are the deviations in f128 ( only used for wide blocks )
+static inline void f128_momentsAddDeviation(f128_momentsBlock* block,dd128 dx,dd128 dy,f128 wideX,f128 wideY){
+  if(!block->wide&&!(f128_momentsInDDRange(dx.hi)&&f128_momentsInDDRange(dy.hi)))
+    f128_momentsWiden(block);
+  if(block->wide){
+    block->wideSumX=F128_UNTRACED(f128_add)(block->wideSumX,wideX);
+    block->wideSumY=F128_UNTRACED(f128_add)(block->wideSumY,wideY);
+    block->wideSumXX=F128_UNTRACED(f128_add)(block->wideSumXX,F128_UNTRACED(f128_mult)(wideX,wideX));
+    block->wideSumYY=F128_UNTRACED(f128_add)(block->wideSumYY,F128_UNTRACED(f128_mult)(wideY,wideY));
+    block->wideSumXY=F128_UNTRACED(f128_add)(block->wideSumXY,F128_UNTRACED(f128_mult)(wideX,wideY));
+  }else{
+    block->sumX=f128_momentsAccumulate(block->sumX,dx);
+    block->sumY=f128_momentsAccumulate(block->sumY,dy);
+    block->sumXX=f128_momentsAccumulate(block->sumXX,dd128_product(dx,dx));
+    block->sumYY=f128_momentsAccumulate(block->sumYY,dd128_product(dy,dy));
+    block->sumXY=f128_momentsAccumulate(block->sumXY,dd128_product(dx,dy));
+  }
+  block->count++;
+}
+// append node, siblings are replaced by their parent,
+// the number of nodes stays below F128_MOMENTS_MAX_NODES since adjacent siblings are always merged
+static void f128_momentsAppendNode(f128_momentsAccumulator* acc,f128_momentsNode node){
+  acc->nodes[acc->nodeCount++]=node;
+  while(acc->nodeCount>=2){
+    f128_momentsNode* left=&acc->nodes[acc->nodeCount-2];
+    f128_momentsNode* right=&acc->nodes[acc->nodeCount-1];
+    if(left->level!=right->level||(left->index&1)!=0||right->index!=left->index+1)
+      break;
+    left->moments=f128_momentsCombine(left->moments,right->moments);
+    left->index>>=1;
+    left->level++;
+    acc->nodeCount--;
+  }
+}
+// append the complete current block as a tree node
+static void f128_momentsPushBlock(f128_momentsAccumulator* acc){
+  f128_momentsNode node={.index=acc->firstBlock+acc->blocks,.level=0,.moments=f128_momentsOfBlock(&acc->block)};
+  acc->blocks++;
+  acc->block=(f128_momentsBlock){.count=0};
+  f128_momentsAppendNode(acc,node);
+}
+
+// accumulator for the samples of the stream starting at sample firstBlock*F128_MOMENTS_BLOCK_SIZE
+void f128_momentsInit(f128_momentsAccumulator* acc,uint64_t firstBlock){
+  acc->firstBlock=firstBlock;
+  acc->blocks=0;
+  acc->nodeCount=0;
+  acc->block=(f128_momentsBlock){.count=0};
+}
+// adds the deviations of x[i] and y[i] from doubles shiftX and shiftY in double-double
+// until a deviation is outside the double-double range, returns the number of added samples
+// the sums are kept in local variables, the loop only depends on the latency of the double-double additions
+static inline size_t f128_momentsAddDD(f128_momentsBlock* block,const double* x,const double* y,size_t count,
+    double shiftX,double shiftY,bool hasY){
+  dd128 sumX=block->sumX,sumY=block->sumY,sumXX=block->sumXX,sumYY=block->sumYY,sumXY=block->sumXY;
+  size_t i=0;
+  for(;i<count;i++){
+    // the deviations from a double are exact double-doubles
+    dd128 dx,dy={0,0};
+    dx.hi=dd128_twoSum(x[i],-shiftX,&dx.low);
+    if(hasY)
+      dy.hi=dd128_twoSum(y[i],-shiftY,&dy.low);
+    if(!(f128_momentsInDDRange(dx.hi)&&f128_momentsInDDRange(dy.hi)))
+      break;
+    sumX=f128_momentsAccumulate(sumX,dx);
+    sumXX=f128_momentsAccumulate(sumXX,dd128_product(dx,dx));
+    if(hasY){
+      sumY=f128_momentsAccumulate(sumY,dy);
+      sumYY=f128_momentsAccumulate(sumYY,dd128_product(dy,dy));
+      sumXY=f128_momentsAccumulate(sumXY,dd128_product(dx,dy));
+    }
+  }
+  block->sumX=sumX;
+  block->sumY=sumY;
+  block->sumXX=sumXX;
+  block->sumYY=sumYY;
+  block->sumXY=sumXY;
+  block->count+=i;
+  return i;
+}
+// add count samples x[i] ( and y[i], y may be NULL for single variable statistics )
+void f128_momentsAddF64(f128_momentsAccumulator* acc,const double* x,const double* y,size_t count){
+  f128_momentsBlock* block=&acc->block;
+  for(size_t i=0;i<count;){
+    if(block->count==0){
+      block->shiftX=f128_fromF64(x[i]);
+      block->shiftY=f128_fromF64(y==NULL?0:y[i]);
+    }
+    size_t end=i+(F128_MOMENTS_BLOCK_SIZE-block->count);
+    if(end>count)
+      end=count;
+    // the shifts of blocks started by f128_momentsAddF128 may not be doubles
+    double shiftX=f128_toF64(block->shiftX),shiftY=f128_toF64(block->shiftY);
+    f128 exactX=f128_fromF64(shiftX),exactY=f128_fromF64(shiftY);
+    bool exact=exactX.hi==block->shiftX.hi&&exactX.low==block->shiftX.low&&
+      exactY.hi==block->shiftY.hi&&exactY.low==block->shiftY.low;
+    while(i<end){
+      if(exact&&!block->wide){
+        if(y==NULL){
+          i+=f128_momentsAddDD(block,x+i,NULL,end-i,shiftX,0,false);
+        }else{
+          i+=f128_momentsAddDD(block,x+i,y+i,end-i,shiftX,shiftY,true);
+        }
+        if(i==end)
+          break;
+      }
+      // deviation outside the double-double range or shift is not a double
+      f128 wideX=F128_UNTRACED(f128_sub)(f128_fromF64(x[i]),block->shiftX);
+      f128 wideY=F128_UNTRACED(f128_sub)(f128_fromF64(y==NULL?0:y[i]),block->shiftY);
+      f128_momentsAddDeviation(block,dd128_fromF128(wideX),dd128_fromF128(wideY),wideX,wideY);
+      i++;
+    }
+    if(block->count==F128_MOMENTS_BLOCK_SIZE)
+      f128_momentsPushBlock(acc);
+  }
+}
+// add count samples x[i] ( and y[i], y may be NULL for single variable statistics ),
+// the deviations from the first sample of the block are rounded to double-double
+void f128_momentsAddF128(f128_momentsAccumulator* acc,const f128* x,const f128* y,size_t count){
+  f128_momentsBlock* block=&acc->block;
+  f128 zero={0};
+  for(size_t i=0;i<count;i++){
+    f128 valueY=y==NULL?zero:y[i];
+    if(block->count==0){
+      block->shiftX=x[i];
+      block->shiftY=valueY;
+    }
+    f128 wideX=F128_UNTRACED(f128_sub)(x[i],block->shiftX);
+    f128 wideY=F128_UNTRACED(f128_sub)(valueY,block->shiftY);
+    f128_momentsAddDeviation(block,dd128_fromF128(wideX),dd128_fromF128(wideY),wideX,wideY);
+    if(block->count==F128_MOMENTS_BLOCK_SIZE)
+      f128_momentsPushBlock(acc);
+  }
+}
+// appends the samples of next, which has to start at the block after the last sample of acc,
+// returns false if acc ends inside a block or next does not start after acc ( acc is not changed then )
+bool f128_momentsMerge(f128_momentsAccumulator* acc,const f128_momentsAccumulator* next){
+  if(next->blocks==0&&next->block.count==0)
+    return true;
+  if(acc->block.count!=0||next->firstBlock!=acc->firstBlock+acc->blocks)
+    return false;
+  for(size_t k=0;k<next->nodeCount;k++){
+    f128_momentsAppendNode(acc,next->nodes[k]);
+  }
+  acc->blocks+=next->blocks;
+  acc->block=next->block;
+  return true;
+}
+// moments of all samples, the nodes and the incomplete block are combined from left to right
+f128_moments f128_momentsResult(const f128_momentsAccumulator* acc){
+  f128_moments r={.count=0};
+  for(size_t k=0;k<acc->nodeCount;k++){
+    r=f128_momentsCombine(r,acc->nodes[k].moments);
+  }
+  return f128_momentsCombine(r,f128_momentsOfBlock(&acc->block));
+}
+// variance of x, divided by count-1 for the sample variance and by count for the population variance
+// NaN if there are less than 2 samples ( 1 for the population variance )
+f128 f128_momentsVariance(f128_moments m,bool sample){
+  if(m.count<(sample?2u:1u))
+    return (f128){.hi=F128_NAN_HI,.low=F128_NAN_LOW};
+  return F128_UNTRACED(f128_div)(m.m2X,f128_fromU64(sample?m.count-1:m.count));
+}
+f128 f128_momentsCovariance(f128_moments m,bool sample){
+  if(m.count<(sample?2u:1u))
+    return (f128){.hi=F128_NAN_HI,.low=F128_NAN_LOW};
+  return F128_UNTRACED(f128_div)(m.cXY,f128_fromU64(sample?m.count-1:m.count));
+}
+// least squares line y=slope*x+intercept
+void f128_momentsRegression(f128_moments m,f128* slope,f128* intercept){
+  *slope=F128_UNTRACED(f128_div)(m.cXY,m.m2X);
+  *intercept=F128_UNTRACED(f128_sub)(m.meanY,F128_UNTRACED(f128_mult)(*slope,m.meanX));
+}
+
+// trace recording and replay
+// a record is the operation ( 1 byte ) followed by the words x.hi,x.low,y.hi,y.low,r.hi,r.low
+// of operands and result in host byte order, y is zero for unary operations
+
+#define F128_TRACE_RECORD_SIZE (1+6*sizeof(uint64_t))
+// maximum number of differing results printed by f128_traceReplay
+#define F128_TRACE_MAX_DIFFS 10
+
+#ifdef F128_TRACE
+static FILE* f128_traceFile;
+static F128_THREAD_LOCAL int f128_traceDepth;
+
+// start recording to file at path, returns false if the file cannot be opened
+bool f128_traceStart(const char* path){
+  if(f128_traceFile!=NULL){
+    fclose(f128_traceFile);
+  }
+  f128_traceFile=fopen(path,"wb");
+  return f128_traceFile!=NULL;
+}
+void f128_traceStop(void){
+  if(f128_traceFile!=NULL){
+    fclose(f128_traceFile);
+    f128_traceFile=NULL;
+  }
+}
+static void f128_traceWrite(f128_op op,f128 x,f128 y,f128 r){
+  if(f128_traceDepth!=0||f128_traceFile==NULL)
+    return;
+  unsigned char record[F128_TRACE_RECORD_SIZE];
+  uint64_t words[6]={x.hi,x.low,y.hi,y.low,r.hi,r.low};
+  record[0]=(unsigned char)op;
+  memcpy(record+1,words,sizeof(words));
+  // single write per record, records of different threads do not interleave
+  fwrite(record,F128_TRACE_RECORD_SIZE,1,f128_traceFile);
+}
+f128 f128_add(f128 x,f128 y){
+  f128_traceDepth++;
+  f128 r=f128_addUntraced(x,y);
+  f128_traceDepth--;
+  f128_traceWrite(F128_OP_ADD,x,y,r);
+  return r;
+}
+f128 f128_sub(f128 x,f128 y){
+  f128_traceDepth++;
+  f128 r=f128_subUntraced(x,y);
+  f128_traceDepth--;
+  f128_traceWrite(F128_OP_SUB,x,y,r);
+  return r;
+}
+f128 f128_mult(f128 x,f128 y){
+  f128_traceDepth++;
+  f128 r=f128_multUntraced(x,y);
+  f128_traceDepth--;
+  f128_traceWrite(F128_OP_MULT,x,y,r);
+  return r;
+}
+f128 f128_inv(f128 x){
+  f128_traceDepth++;
+  f128 r=f128_invUntraced(x);
+  f128_traceDepth--;
+  f128_traceWrite(F128_OP_INV,x,(f128){.hi=0,.low=0},r);
+  return r;
+}
+f128 f128_div(f128 x,f128 y){
+  f128_traceDepth++;
+  f128 r=f128_divUntraced(x,y);
+  f128_traceDepth--;
+  f128_traceWrite(F128_OP_DIV,x,y,r);
+  return r;
+}
+#endif
+
+typedef struct{
+  f128_op op;
+  f128 x;
+  f128 y;
+  f128 expected;// result in trace
+  f128 actual;// result of current build
+}f128_traceEntry;
+
+static f128 f128_traceExecute(f128_op op,f128 x,f128 y){
+  switch(op){
+    case F128_OP_ADD:
+      return F128_UNTRACED(f128_add)(x,y);
+    case F128_OP_SUB:
+      return F128_UNTRACED(f128_sub)(x,y);
+    case F128_OP_MULT:
+      return F128_UNTRACED(f128_mult)(x,y);
+    case F128_OP_INV:
+      return F128_UNTRACED(f128_inv)(x);
+    default:
+      return F128_UNTRACED(f128_div)(x,y);
+  }
+}
+// reads trace at path, sorted by operation, stores number of entries in count
+static f128_traceEntry* f128_traceRead(const char* path,size_t* count){
+  FILE* in=fopen(path,"rb");
+  if(in==NULL)
+    return NULL;
+  size_t n=0,capacity=1024;
+  size_t perOp[F128_OP_COUNT]={0};
+  f128_traceEntry* entries=malloc(capacity*sizeof(f128_traceEntry));
+  unsigned char record[F128_TRACE_RECORD_SIZE];
+  while(entries!=NULL&&fread(record,F128_TRACE_RECORD_SIZE,1,in)==1){
+    if(record[0]>=F128_OP_COUNT)
+      continue;
+    if(n==capacity){
+      capacity*=2;
+      f128_traceEntry* grown=realloc(entries,capacity*sizeof(f128_traceEntry));
+      if(grown==NULL){
+        free(entries);
+        entries=NULL;
+        break;
+      }
+      entries=grown;
+    }
+    uint64_t words[6];
+    memcpy(words,record+1,sizeof(words));
+    entries[n++]=(f128_traceEntry){
+      .op=(f128_op)record[0],
+      .x={.hi=words[0],.low=words[1]},
+      .y={.hi=words[2],.low=words[3]},
+      .expected={.hi=words[4],.low=words[5]}
+    };
+    perOp[record[0]]++;
+  }
+  fclose(in);
+  if(entries==NULL)
+    return NULL;
+  // counting sort by operation, such that each operation is timed in one loop
+  f128_traceEntry* sorted=malloc((n>0?n:1)*sizeof(f128_traceEntry));
+  if(sorted!=NULL){
+    size_t start[F128_OP_COUNT];
+    size_t sum=0;
+    for(int op=0;op<F128_OP_COUNT;op++){
+      start[op]=sum;
+      sum+=perOp[op];
+    }
+    for(size_t i=0;i<n;i++){
+      sorted[start[entries[i].op]++]=entries[i];
+    }
+  }
+  free(entries);
+  *count=n;
+  return sorted;
+}
+// re-executes the operations in the trace at path with the current build,
+// prints number of calls, time per call, throughput and number of results that differ from the trace
+// returns false if the trace cannot be read
+bool f128_traceReplay(const char* path,FILE* out){
+  size_t n;
+  f128_traceEntry* entries=f128_traceRead(path,&n);
+  if(entries==NULL)
+    return false;
+  int printed=0;
+  for(size_t first=0;first<n;){
+    f128_op op=entries[first].op;
+    size_t end=first;
+    while(end<n&&entries[end].op==op){
+      end++;
+    }
+    clock_t start=clock();
+    for(size_t i=first;i<end;i++){
+      entries[i].actual=f128_traceExecute(op,entries[i].x,entries[i].y);
+    }
+    double seconds=(double)(clock()-start)/CLOCKS_PER_SEC;
+    size_t diffs=0;
+    for(size_t i=first;i<end;i++){
+      f128 e=entries[i].expected,a=entries[i].actual;
+      if((e.hi!=a.hi||e.low!=a.low)&&!(f128_isNaN(e)&&f128_isNaN(a))){
+        diffs++;
+        if(printed++<F128_TRACE_MAX_DIFFS){
+          fprintf(out,"diff %s %016"PRIx64" %016"PRIx64" %016"PRIx64" %016"PRIx64": %016"PRIx64" %016"PRIx64" -> %016"PRIx64" %016"PRIx64"\n",
+            f128_opNames[op],entries[i].x.hi,entries[i].x.low,entries[i].y.hi,entries[i].y.low,e.hi,e.low,a.hi,a.low);
+        }
+      }
+    }
+    size_t calls=end-first;
+    fprintf(out,"%-4s calls: %zu ns/call: %.1f Mops/s: %.2f diffs: %zu\n",f128_opNames[op],calls,
+      seconds*1e9/(double)calls,seconds>0?(double)calls/seconds*1e-6:0.0,diffs);
+    first=end;
+  }
+  free(entries);
+  return true;
+}
+
+int main(int argc,char** argv){
+  // f128 --replay <trace>: benchmark current build with recorded operations
+  if(argc==3&&strcmp(argv[1],"--replay")==0)
+    return f128_traceReplay(argv[2],stdout)?0:1;
+  // f128 --dd-bench <count>: compare speed and accuracy of double-double with f128
+  if(argc==3&&strcmp(argv[1],"--dd-bench")==0)
+    return dd128_benchmark(strtoull(argv[2],NULL,10),stdout)?0:1;
+  // f128 --fft-bench <n>: compare c128_fft with the O(n^2) dft for sizes up to n
+  if(argc==3&&strcmp(argv[1],"--fft-bench")==0)
+    return c128_fftBenchmark(strtoull(argv[2],NULL,10),stdout)?0:1;
+#ifdef F128_TRACE
+  // f128 --trace <trace>: record operations of this demo
+  if(argc==3&&strcmp(argv[1],"--trace")==0&&!f128_traceStart(argv[2])){
+    fprintf(stderr,"cannot open %s\n",argv[2]);
+    return 1;
+  }
+#endif
+  f128 a={(F128_EXP_BIAS<<F128_HI_EXP_SHIFT)|1,0},
+       b={(F128_EXP_BIAS<<F128_HI_EXP_SHIFT)|1,0},c=f128_mult(a,b);
+  printf("%016lx %016lx\n",a.hi,a.low);
+  printf("%016lx %016lx\n",b.hi,b.low);
   printf("%016lx %016lx\n",c.hi,c.low);
   a=(f128){0xfffffffffffflu,0xfffffffffffffffflu};
   b=(f128){((F128_EXP_BIAS)<<F128_HI_EXP_SHIFT)|0xfffffffffffflu,0xfffffffffffffffflu};
@@ -721,6 +3396,9 @@ int main(void){
   printf("%016lx %016lx\n",b.hi,b.low);
   printf("%016lx %016lx\n",c.hi,c.low);
   printf("%f\n",f128_toF64(c));
+  // signed zeros stay zero
+  a=f128_fromF64(-0.0);
+  printf("%016lx %016lx\n",a.hi,a.low);
   double x=2.5e-162;
   a=f128_fromF64(x);
   printf("%016lx %016lx\n",a.hi,a.low);
@@ -742,6 +3420,16 @@ int main(void){
   c=f128_sub(b,a);
   printf("%016lx %016lx\n",c.hi,c.low);
   printf("%f\n",f128_toF64(c));
+  // rounding of the aligned operand: 1+2^-113 is a tie ( rounds to 1 ), 1+3*2^-114 rounds up
+  a=f128_fromF64(1);
+  c=f128_add(a,f128_fromF64(0x1p-113));
+  printf("%016lx %016lx\n",c.hi,c.low);
+  c=f128_add(a,f128_fromF64(0x3p-114));
+  printf("%016lx %016lx\n",c.hi,c.low);
+  // x-y with |y| much larger than |x| -> -y
+  c=f128_sub(a,f128_fromF64(0x1p200));
+  printf("%016lx %016lx %g\n",c.hi,c.low,f128_toF64(c));
+  a=f128_fromF64(3.141592653589793238);
   c=f128_inv(a);
   printf("%016lx %016lx\n",a.hi,a.low);
   printf("%016lx %016lx\n",c.hi,c.low);
@@ -775,6 +3463,126 @@ int main(void){
   c=f128_div(b,a);
   printf("%016lx %016lx\n",c.hi,c.low);
   printf("%f\n",f128_toF64(c));
+  // 0/y -> 0 with the sign of the quotient
+  f128 zeroQuotient=f128_div((f128){.hi=F128_HI_SIGN_FLAG,.low=0},b);
+  printf("%016lx %016lx\n",zeroQuotient.hi,zeroQuotient.low);
+
+  f128 values[4]={a,b,c,c};
+  uint64_t words[16];
+  f128_xorEncoder enc;
+  f128_xorEncoderInit(&enc,words,16,NULL);
+  for(int i=0;i<4;i++){
+    f128_xorEncode(&enc,values[i]);
+  }
+  f128_xorDecode(words,4,values);
+  printf("%zu words\n",f128_xorEncoderSize(&enc));
+  for(int i=0;i<4;i++){
+    printf("%016lx %016lx\n",values[i].hi,values[i].low);
+  }
+  // encoding into a full buffer fails without changing the encoder, the value can be encoded again with more capacity
+  f128 retryValues[6]={a,b,c,f128_fromF64(0.1),f128_fromF64(-7),f128_fromF64(0.1)};
+  f128 retryDecoded[6];
+  f128_xorEncoderInit(&enc,words,3,NULL);
+  int retries=0;
+  for(int i=0;i<6;i++){
+    if(!f128_xorEncode(&enc,retryValues[i])){
+      enc.capacity=16;
+      retries++;
+      f128_xorEncode(&enc,retryValues[i]);
+    }
+  }
+  f128_xorDecode(words,6,retryDecoded);
+  printf("retries: %d round trip: %s\n",retries,memcmp(retryValues,retryDecoded,sizeof(retryValues))==0?"ok":"failed");
+  c=f128_uniform(0x0123456789abcdefull,0xfedcba9876543210ull);
+  printf("%016lx %016lx\n",c.hi,c.low);
+  printf("%f\n",f128_toF64(c));
+  c128 signal[4]={
+    {f128_fromF64(1),f128_fromF64(0)},{f128_fromF64(2),f128_fromF64(0)},
+    {f128_fromF64(3),f128_fromF64(0)},{f128_fromF64(4),f128_fromF64(0)}
+  };
+  c128_fftPlan plan;
+  c128_fftPlanInit(&plan,4);
+  c128_fft(&plan,signal,false);
+  for(int i=0;i<4;i++){
+    printf("%f %f\n",f128_toF64(signal[i].re),f128_toF64(signal[i].im));
+  }
+  c128_fft(&plan,signal,true);
+  for(int i=0;i<4;i++){
+    printf("%f %f\n",f128_toF64(signal[i].re),f128_toF64(signal[i].im));
+  }
+  c128_fftPlanFree(&plan);
+  // hilbert matrix
+  f128 matrix[9],rhs[3],solution[3];
+  for(int i=0;i<3;i++){
+    for(int j=0;j<3;j++){
+      matrix[i*3+j]=f128_div(f128_fromF64(1),f128_fromF64(i+j+1));
+    }
+    rhs[i]=f128_fromF64(1);
+  }
+  int iterations;
+  f128_solve(3,matrix,rhs,solution,10,&iterations);
+  printf("%d iterations\n",iterations);
+  for(int i=0;i<3;i++){
+    printf("%016lx %016lx\n",solution[i].hi,solution[i].low);
+  }
+  // 1+x+x^2/2+x^3/6 and 1-x/2
+  f128 coefficients[4]={f128_fromF64(1),f128_fromF64(1),f128_fromF64(0.5),f128_div(f128_fromF64(1),f128_fromF64(6))};
+  f128 denominator[2]={f128_fromF64(1),f128_fromF64(-0.5)};
+  f128_poly p,q;
+  f128_polyInit(&p,coefficients,4);
+  f128_polyInit(&q,denominator,2);
+  c=f128_polyEval(&p,f128_fromF64(0.5));
+  printf("%016lx %016lx\n",c.hi,c.low);
+  c=f128_rationalEval(&p,&q,f128_fromF64(0.5));
+  printf("%016lx %016lx\n",c.hi,c.low);
+  f128_polyFree(&p);
+  f128_polyFree(&q);
+  a=f128_fromF64(-2.5);
+  printf("%f %f %f %f\n",f128_toF64(f128_floor(a)),f128_toF64(f128_ceil(a)),
+    f128_toF64(f128_round(a)),f128_toF64(f128_nearbyint(a)));
+  int exp;
+  c=f128_frexp(f128_fromF64(48),&exp);
+  printf("%f %d\n",f128_toF64(c),exp);
+  c=f128_fmod(f128_fromF64(10),f128_fromF64(3));
+  printf("%f\n",f128_toF64(c));
+  c=f128_remainder(f128_fromF64(11),f128_fromF64(3));
+  printf("%f\n",f128_toF64(c));
+  f128 factors[4]={f128_fromF64(1.5),f128_fromF64(-3),f128_fromF64(0.1),f128_fromF64(1e300)};
+  f128 products[4];
+  f128_mult4(factors,factors,products);
+  for(int i=0;i<4;i++){
+    printf("%016lx %016lx\n",products[i].hi,products[i].low);
+  }
+  // enclosure of 1/10*3
+  f128_interval tenth=f128_intervalPoint(f128_div(f128_fromF64(1),f128_fromF64(10)));
+  f128_interval range=f128_intervalMult(tenth,f128_intervalPoint(f128_fromF64(3)));
+  printf("[%016lx %016lx, %016lx %016lx]\n",range.lo.hi,range.lo.low,range.hi.hi,range.hi.low);
+  // [0,1]*[1,Infinity] = [0,Infinity]
+  range=f128_intervalMult((f128_interval){.lo={.hi=0,.low=0},.hi=f128_fromF64(1)},
+    (f128_interval){.lo=f128_fromF64(1),.hi={.hi=F128_INF_HI,.low=F128_INF_LOW}});
+  printf("[%g, %g]\n",f128_toF64(range.lo),f128_toF64(range.hi));
+  dd128 two=dd128_sqrt(dd128_fromF64(2));
+  c=dd128_toF128(dd128_mult(two,two));
+  printf("%.17g %.17g %016lx %016lx\n",two.hi,two.low,c.hi,c.low);
+  // variance of values with a large common offset, two accumulators for consecutive chunks of the stream
+  static double samples[3*F128_MOMENTS_BLOCK_SIZE];
+  for(int i=0;i<3*F128_MOMENTS_BLOCK_SIZE;i++){
+    samples[i]=1e9+(i%7)*0x1p-20;
+  }
+  static f128_momentsAccumulator first,second;
+  f128_momentsInit(&first,0);
+  f128_momentsInit(&second,1);
+  f128_momentsAddF64(&first,samples,NULL,F128_MOMENTS_BLOCK_SIZE);
+  f128_momentsAddF64(&second,samples+F128_MOMENTS_BLOCK_SIZE,NULL,2*F128_MOMENTS_BLOCK_SIZE);
+  f128_momentsMerge(&first,&second);
+  f128_moments moments=f128_momentsResult(&first);
+  printf("%.17g %.17g\n",f128_toF64(moments.meanX),f128_toF64(f128_momentsVariance(moments,true)));
+#ifdef F128_TRACE
+  f128_traceStop();
+#endif
+#ifdef F128_INSTRUMENT
+  f128_statsDump(stdout);
+#endif
 }
 
 
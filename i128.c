@@ -3,6 +3,10 @@
 #include <string.h>
 #include <stdbool.h>
 #include <inttypes.h>
+#include <time.h>
+#ifdef I128_SCAN_THREADS
+#include <pthread.h>
+#endif
 
 #define I64_HI_BIT 0x8000000000000000ull
 #define I32_MASK 0xffffffffull
@@ -13,6 +17,37 @@ typedef struct{
   uint64_t low;
 }i128;
 
+// state of pseudo random number generator
+typedef struct{
+  i128 state;
+  i128 inc;// has to be odd, selects the stream
+}i128_pcg;
+
+// fixed point decimal, stores value*10^scale,
+// the scale ( 0 to DEC128_MAX_SCALE ) is passed to each operation
+typedef i128 dec128;
+
+#define DEC128_MAX_SCALE 38
+// sign, 39 digits, decimal point and terminating zero
+#define DEC128_FORMAT_SIZE 42
+
+// rational number num/den, den is positive, the fraction is not necessarily reduced
+typedef struct{
+  i128 num;
+  i128 den;
+}r128;
+
+// binary floating point value, same layout as f128 in f128.c
+typedef struct{
+  uint64_t hi;
+  uint64_t low;
+}f128;
+// [sign:1][exp:15][mantissa:112]
+
+#define F128_HI_EXP_SHIFT 48
+#define F128_EXP_BIAS  0x3fffull
+#define F128_HI_MANTISSA_MASK 0xffffffffffffull
+
 i128 i128_not(i128);
 i128 i128_and(i128,i128);
 i128 i128_or(i128,i128);
@@ -30,8 +65,136 @@ i128 i128_add(i128,i128);
 i128 i128_sub(i128,i128);
 i128 i64_bigMult(uint64_t,uint64_t);
 i128 i128_mult(i128,i128);
+i128 i128_bigMult(i128,i128,i128*);
 i128 i128_unsignedDivMod(i128,i128,i128*);
 i128 i128_divMod(i128,i128,i128*);
+i128 i128_zigzagEncode(i128);
+i128 i128_zigzagDecode(i128);
+size_t i128_packBound(size_t);
+size_t i128_packBlock(const i128*,size_t,uint64_t*);
+size_t i128_unpackBlock(const uint64_t*,size_t,i128*);
+size_t i128_pack(const i128*,size_t,uint64_t*,size_t*);
+void i128_unpack(const uint64_t*,size_t,i128*);
+void i128_pcgSeed(i128_pcg*,i128,i128);
+i128 i128_pcgNext(i128_pcg*);
+i128 i128_pcgBounded(i128_pcg*,i128);
+void i128_pcgAdvance(i128_pcg*,i128);
+void i128_pcgFill(i128_pcg*,i128*,size_t);
+void i128_pcgFillBounded(i128_pcg*,i128,i128*,size_t);
+i128 i128_gcd(i128,i128);
+i128 i128_extendedGcd(i128,i128,i128*,i128*);
+bool i128_modInverse(i128,i128,i128*);
+i128 i128_sqrt(i128);
+i128 i128_pow(i128,unsigned int,bool*);
+bool i128_numberTheoryBenchmark(size_t,FILE*);
+i128 i128_sum(const i128*,size_t,bool*);
+i128 i128_inclusiveScan(const i128*,i128*,size_t,i128,bool*);
+i128 i128_exclusiveScan(const i128*,i128*,size_t,i128,bool*);
+i128 i128_segmentedScan(const i128*,const bool*,i128*,size_t,i128,bool*);
+i128 i128_segmentedSum(const i128*,const bool*,size_t,bool*,bool*);
+i128 i128_segmentedScanByKey(const i128*,const uint64_t*,i128*,size_t,uint64_t,i128,bool*);
+i128 i128_segmentedSumByKey(const i128*,const uint64_t*,size_t,uint64_t,bool*,bool*);
+i128 i128_inclusiveScanBlocked(const i128*,i128*,size_t,i128,size_t,bool*);
+i128 i128_exclusiveScanBlocked(const i128*,i128*,size_t,i128,size_t,bool*);
+i128 i128_segmentedScanBlocked(const i128*,const bool*,i128*,size_t,i128,size_t,bool*);
+i128 i128_segmentedScanByKeyBlocked(const i128*,const uint64_t*,i128*,size_t,uint64_t,i128,size_t,bool*);
+dec128 dec128_add(dec128,dec128,bool*);
+dec128 dec128_sub(dec128,dec128,bool*);
+dec128 dec128_mult(dec128,dec128,unsigned int,bool*);
+dec128 dec128_div(dec128,dec128,unsigned int,bool*);
+dec128 dec128_rescale(dec128,unsigned int,unsigned int,bool*);
+bool dec128_parse(const char*,unsigned int,dec128*);
+size_t dec128_format(dec128,unsigned int,char*);
+void dec128_addArray(const dec128*,const dec128*,dec128*,size_t,bool*);
+void dec128_multArray(const dec128*,const dec128*,dec128*,size_t,unsigned int,bool*);
+void dec128_rescaleArray(const dec128*,dec128*,size_t,unsigned int,unsigned int,bool*);
+dec128 dec128_sum(const dec128*,size_t,bool*);
+r128 r128_make(i128,i128,bool*);
+r128 r128_reduce(r128);
+r128 r128_add(r128,r128,bool*);
+r128 r128_sub(r128,r128,bool*);
+r128 r128_mult(r128,r128,bool*);
+r128 r128_div(r128,r128,bool*);
+int r128_compare(r128,r128);
+f128 r128_toF128(r128);
+bool i128_traceReplay(const char*,FILE*);
+
+// instrumentation, enabled by compiling with -DI128_INSTRUMENT
+// counters are per-thread and include calls made internally (e.g. by i128_divMod)
+
+typedef enum{
+  I128_OP_MULT,
+  I128_OP_UNSIGNED_DIV_MOD,
+  I128_OP_DIV_MOD,
+  I128_OP_COUNT
+}i128_op;
+
+static const char* i128_opNames[I128_OP_COUNT]={"mult","unsignedDivMod","divMod"};
+
+#if __STDC_VERSION__>=201112L
+#define I128_THREAD_LOCAL _Thread_local
+#else
+#define I128_THREAD_LOCAL __thread
+#endif
+
+#ifdef I128_INSTRUMENT
+// a division loop runs between 1 and 128 iterations
+#define I128_DIV_LOOP_BUCKETS 129
+
+typedef struct{
+  uint64_t calls[I128_OP_COUNT];
+  uint64_t divSmall;// dividend smaller than divisor
+  uint64_t div64;// both operands fit in 64 bits
+  uint64_t divLoop;// bit-serial division loop
+  uint64_t divLoopIterations[I128_DIV_LOOP_BUCKETS];
+}i128_stats;
+
+static I128_THREAD_LOCAL i128_stats i128_threadStats;
+
+// division by zero gives 129 iterations, counted in the last bucket
+static void i128_countDivLoop(int iterations){
+  i128_threadStats.divLoopIterations[iterations<I128_DIV_LOOP_BUCKETS-1?iterations:I128_DIV_LOOP_BUCKETS-1]++;
+}
+
+#define I128_COUNT(counter) (i128_threadStats.counter++)
+#define I128_COUNT_DIV_LOOP(iterations) i128_countDivLoop(iterations)
+
+i128_stats i128_statsGet(void){
+  return i128_threadStats;
+}
+void i128_statsReset(void){
+  memset(&i128_threadStats,0,sizeof(i128_stats));
+}
+void i128_statsDump(FILE* out){
+  for(int i=0;i<I128_OP_COUNT;i++){
+    fprintf(out,"%-14s calls: %"PRIu64"\n",i128_opNames[i],i128_threadStats.calls[i]);
+  }
+  fprintf(out,"division small: %"PRIu64" 64-bit: %"PRIu64" loop: %"PRIu64"\n",
+    i128_threadStats.divSmall,i128_threadStats.div64,i128_threadStats.divLoop);
+  fprintf(out,"division loop iterations:\n");
+  for(int i=0;i<I128_DIV_LOOP_BUCKETS;i++){
+    if(i128_threadStats.divLoopIterations[i]!=0){
+      fprintf(out,"%3d: %"PRIu64"\n",i,i128_threadStats.divLoopIterations[i]);
+    }
+  }
+}
+#else
+#define I128_COUNT(counter) ((void)0)
+#define I128_COUNT_DIV_LOOP(iterations) ((void)0)
+#endif
+
+// operation tracing, enabled by compiling with -DI128_TRACE
+// calls of the operations in i128_op are appended to the file given to i128_traceStart,
+// calls nested inside another traced operation are not recorded
+// the operations are compiled as <name>Untraced and wrapped by recording functions
+#ifdef I128_TRACE
+#define I128_UNTRACED(name) name##Untraced
+i128 i128_multUntraced(i128,i128);
+i128 i128_unsignedDivModUntraced(i128,i128,i128*);
+i128 i128_divModUntraced(i128,i128,i128*);
+#else
+#define I128_UNTRACED(name) name
+#endif
 
 i128 i128_not(i128 a){
   return (i128){
@@ -154,7 +317,7 @@ int i128_unsignedCompare(i128 a,i128 b){
     return -1;
   if(a.hi>b.hi)
     return 1;
-  return (a.low<b.low)?-1:(a.hi>b.hi)?1:0;
+  return (a.low<b.low)?-1:(a.low>b.low)?1:0;
 }
 int i128_compare(i128 a,i128 b){
   if((a.hi&I64_HI_BIT)==(b.hi&I64_HI_BIT)){
@@ -194,13 +357,15 @@ i128 i64_bigMult(uint64_t a,uint64_t b){
   uint64_t x01=aLow*bHi;
   uint64_t x10=aHi*bLow;
   uint64_t x11=aHi*bHi;
-  uint64_t carry=((x00>>32)+(x01&I32_MASK)+(x10&I32_MASK))>>32;
+  // x01+x10 may overflow, add middle terms in 32-bit parts
+  uint64_t mid=(x00>>32)+(x01&I32_MASK)+(x10&I32_MASK);
   return (i128){
-    .low=x00+((x01+x10)<<32),
-    .hi=x11+((x01+x10)>>32)+carry
+    .low=(x00&I32_MASK)|(mid<<32),
+    .hi=x11+(x01>>32)+(x10>>32)+(mid>>32)
   };
 }
-i128 i128_mult(i128 a,i128 b){
+i128 I128_UNTRACED(i128_mult)(i128 a,i128 b){
+  I128_COUNT(calls[I128_OP_MULT]);
   // (a+b*2^64) (c+d*2^64) = a*c+2^64*(a*d+b*c)+2^128*(b*d)
   i128 x00=i64_bigMult(a.low,b.low);
   return (i128){
@@ -208,9 +373,39 @@ i128 i128_mult(i128 a,i128 b){
     .hi=x00.hi+a.low*b.hi+a.hi*b.low
   };
 }
+// unsigned 256-bit product, returns low 128 bits and stores high 128 bits in hi
+i128 i128_bigMult(i128 a,i128 b,i128* hi){
+  i128 x00=i64_bigMult(a.low,b.low);
+  i128 x01=i64_bigMult(a.low,b.hi);
+  i128 x10=i64_bigMult(a.hi,b.low);
+  i128 x11=i64_bigMult(a.hi,b.hi);
+  // middle 128 bits: x00.hi+x01+x10
+  i128 mid=i128_add((i128){.hi=0,.low=x00.hi},x01);
+  uint64_t carry=i128_unsignedCompare(mid,x01)<0;
+  mid=i128_add(mid,x10);
+  carry+=i128_unsignedCompare(mid,x10)<0;
+  if(hi!=NULL){
+    *hi=i128_add(x11,(i128){.hi=carry,.low=mid.hi});
+  }
+  return (i128){
+    .low=x00.low,
+    .hi=mid.low
+  };
+}
 
-i128 i128_unsignedDivMod(i128 a,i128 b,i128* mod){
-  if((a.hi<b.hi)||((a.hi==b.hi) && (a.low<=b.low))){ // a <= b
+i128 I128_UNTRACED(i128_unsignedDivMod)(i128 a,i128 b,i128* mod){
+  I128_COUNT(calls[I128_OP_UNSIGNED_DIV_MOD]);
+  if((b.hi|b.low)==0){ // division by zero: quotient is all ones, remainder is a
+    if(mod!=NULL){
+      *mod=a;
+    }
+    return (i128){
+      .hi=UINT64_MAX,
+      .low=UINT64_MAX
+    };
+  }
+  if((a.hi<b.hi)||((a.hi==b.hi) && (a.low<b.low))){ // a < b
+    I128_COUNT(divSmall);
     if(mod!=NULL){
       *mod=a;
     }
@@ -220,6 +415,7 @@ i128 i128_unsignedDivMod(i128 a,i128 b,i128* mod){
     };
   }
   if(a.hi==0){ // both fit in 64 bits
+    I128_COUNT(div64);
     if(mod!=NULL){
       *mod=(i128){
         .hi=0,
@@ -231,8 +427,10 @@ i128 i128_unsignedDivMod(i128 a,i128 b,i128* mod){
       .low=a.low/b.low
     };
   }
-  // TODO handle more special cases ( b.hi=0,b.low=0,b=2^k, ... )
+  // TODO handle more special cases ( b.hi=0,b=2^k, ... )
   int shift=i128_highestSetBit(a)-i128_highestSetBit(b);
+  I128_COUNT(divLoop);
+  I128_COUNT_DIV_LOOP(shift+1);
   i128 bit={.hi=0,.low=0},res={.hi=0,.low=0};
   i128 div=i128_leftShift(b,shift);
   if(shift>=64){
@@ -254,7 +452,8 @@ i128 i128_unsignedDivMod(i128 a,i128 b,i128* mod){
   return res;
 }
 // TODO check if signs are correct
-i128 i128_divMod(i128 a,i128 b,i128* mod){
+i128 I128_UNTRACED(i128_divMod)(i128 a,i128 b,i128* mod){
+  I128_COUNT(calls[I128_OP_DIV_MOD]);
   bool resSign=false,modSign=false;
   if(a.hi&I64_HI_BIT){
     a=i128_negate(a);
@@ -275,7 +474,1731 @@ i128 i128_divMod(i128 a,i128 b,i128* mod){
   return res;
 }
 
-int main(void){
+// compression codec for i128 columns
+// blocks of up to I128_PACK_BLOCK_SIZE values are stored as
+//  [bit width][first value hi][first value low][zigzag encoded deltas packed to bit width]
+
+#define I128_PACK_BLOCK_SIZE 128
+
+i128 i128_zigzagEncode(i128 x){
+  return i128_xor(i128_leftShift(x,1),i128_arithmeticRightShift(x,127));
+}
+i128 i128_zigzagDecode(i128 x){
+  uint64_t sign=-(x.low&1);
+  return (i128){
+    .low=((x.low>>1)|(x.hi<<63))^sign,
+    .hi=(x.hi>>1)^sign
+  };
+}
+
+// maximum number of words needed to pack count values
+size_t i128_packBound(size_t count){
+  size_t blocks=(count+I128_PACK_BLOCK_SIZE-1)/I128_PACK_BLOCK_SIZE;
+  return 3*blocks+2*count;
+}
+// pack count (<=I128_PACK_BLOCK_SIZE) values, returns number of words written
+size_t i128_packBlock(const i128* values,size_t count,uint64_t* out){
+  if(count==0)
+    return 0;
+  i128 bits={.hi=0,.low=0};
+  for(size_t i=1;i<count;i++){
+    bits=i128_or(bits,i128_zigzagEncode(i128_sub(values[i],values[i-1])));
+  }
+  int width=i128_highestSetBit(bits);
+  out[0]=width;
+  out[1]=values[0].hi;
+  out[2]=values[0].low;
+  uint64_t* words=out+3;
+  size_t n=0;// words written
+  uint64_t acc=0;// partially filled word
+  int used=0;// bits used in acc
+  for(size_t i=1;i<count&&width>0;i++){
+    i128 z=i128_zigzagEncode(i128_sub(values[i],values[i-1]));
+    // append the upper part first to keep the bit order of the value
+    uint64_t parts[2]={z.hi,z.low};
+    int sizes[2]={width>64?width-64:0,width>64?64:width};
+    for(int k=0;k<2;k++){
+      int size=sizes[k];
+      if(size==0)
+        continue;
+      uint64_t v=parts[k];
+      int free=64-used;
+      if(size<free){
+        acc|=v<<(free-size);
+        used+=size;
+      }else{
+        words[n++]=acc|(v>>(size-free));
+        used=size-free;
+        acc=used?v<<(64-used):0;
+      }
+    }
+  }
+  if(used>0)
+    words[n++]=acc;
+  return 3+n;
+}
+// unpack count values, returns number of words read
+size_t i128_unpackBlock(const uint64_t* in,size_t count,i128* out){
+  if(count==0)
+    return 0;
+  int width=(int)in[0];
+  i128 prev={.hi=in[1],.low=in[2]};
+  out[0]=prev;
+  const uint64_t* words=in+3;
+  if(width==0){
+    for(size_t i=1;i<count;i++)
+      out[i]=prev;
+    return 3;
+  }
+  int hiWidth=width>64?width-64:0;
+  int lowWidth=width>64?64:width;
+  size_t pos=0;// bit position
+  for(size_t i=1;i<count;i++){
+    i128 z={.hi=0,.low=0};
+    if(hiWidth>0){
+      size_t w=pos>>6;
+      int off=pos&63;
+      // bits are stored msb first, read a (possibly unaligned) 64-bit window
+      uint64_t window=words[w]<<off;
+      if(off+hiWidth>64)
+        window|=words[w+1]>>(64-off);
+      z.hi=window>>(64-hiWidth);
+      pos+=hiWidth;
+    }
+    size_t w=pos>>6;
+    int off=pos&63;
+    uint64_t window=words[w]<<off;
+    if(off>0&&off+lowWidth>64)
+      window|=words[w+1]>>(64-off);
+    z.low=window>>(64-lowWidth);
+    pos+=lowWidth;
+    prev=i128_add(prev,i128_zigzagDecode(z));
+    out[i]=prev;
+  }
+  return 3+((pos+63)>>6);
+}
+// pack values in blocks of I128_PACK_BLOCK_SIZE,
+// stores the word offset of each block in blockOffsets (if not NULL)
+// returns number of words written
+size_t i128_pack(const i128* values,size_t count,uint64_t* out,size_t* blockOffsets){
+  size_t n=0;
+  for(size_t i=0;i<count;i+=I128_PACK_BLOCK_SIZE){
+    if(blockOffsets!=NULL)
+      blockOffsets[i/I128_PACK_BLOCK_SIZE]=n;
+    size_t len=count-i<I128_PACK_BLOCK_SIZE?count-i:I128_PACK_BLOCK_SIZE;
+    n+=i128_packBlock(values+i,len,out+n);
+  }
+  return n;
+}
+void i128_unpack(const uint64_t* in,size_t count,i128* out){
+  for(size_t i=0;i<count;i+=I128_PACK_BLOCK_SIZE){
+    size_t len=count-i<I128_PACK_BLOCK_SIZE?count-i:I128_PACK_BLOCK_SIZE;
+    in+=i128_unpackBlock(in,len,out+i);
+  }
+}
+
+// pseudo random number generator
+// PCG with 128-bit state (https://www.pcg-random.org), XSL-RR output function
+// every i128 value is built from two 64-bit outputs
+
+#define I128_PCG_MULT_HI  0x2360ed051fc65da4ull
+#define I128_PCG_MULT_LOW 0x4385df649fccf645ull
+
+static uint64_t i128_pcgStep(i128_pcg* rng){
+  rng->state=i128_add(i128_mult(rng->state,(i128){.hi=I128_PCG_MULT_HI,.low=I128_PCG_MULT_LOW}),rng->inc);
+  uint64_t x=rng->state.hi^rng->state.low;
+  unsigned int rot=rng->state.hi>>58;
+  return (x>>rot)|(x<<((64-rot)&63));
+}
+// generators with different streams produce independent sequences
+void i128_pcgSeed(i128_pcg* rng,i128 seed,i128 stream){
+  rng->state=(i128){.hi=0,.low=0};
+  rng->inc=i128_or(i128_leftShift(stream,1),(i128){.hi=0,.low=1});
+  i128_pcgStep(rng);
+  rng->state=i128_add(rng->state,seed);
+  i128_pcgStep(rng);
+}
+i128 i128_pcgNext(i128_pcg* rng){
+  uint64_t hi=i128_pcgStep(rng);
+  return (i128){
+    .hi=hi,
+    .low=i128_pcgStep(rng)
+  };
+}
+// uniformly distributed value in [0,bound) (unsigned)
+// uses the upper half of the 256-bit product with bound, rejects biased samples
+i128 i128_pcgBounded(i128_pcg* rng,i128 bound){
+  i128 hi;
+  i128 low=i128_bigMult(i128_pcgNext(rng),bound,&hi);
+  if(i128_unsignedCompare(low,bound)<0){
+    // threshold = 2^128 mod bound
+    i128 threshold;
+    i128_unsignedDivMod(i128_negate(bound),bound,&threshold);
+    while(i128_unsignedCompare(low,threshold)<0){
+      low=i128_bigMult(i128_pcgNext(rng),bound,&hi);
+    }
+  }
+  return hi;
+}
+// skip the next count values in O(log(count)) steps
+// ( Brown, "Random Number Generation with Arbitrary Stride" )
+void i128_pcgAdvance(i128_pcg* rng,i128 count){
+  i128 delta=i128_leftShift(count,1);// two steps per value
+  i128 accMult={.hi=0,.low=1},accPlus={.hi=0,.low=0};
+  i128 curMult={.hi=I128_PCG_MULT_HI,.low=I128_PCG_MULT_LOW},curPlus=rng->inc;
+  while(delta.hi|delta.low){
+    if(delta.low&1){
+      accMult=i128_mult(accMult,curMult);
+      accPlus=i128_add(i128_mult(accPlus,curMult),curPlus);
+    }
+    curPlus=i128_mult(i128_add(curMult,(i128){.hi=0,.low=1}),curPlus);
+    curMult=i128_mult(curMult,curMult);
+    delta=i128_logicalRightShift(delta,1);
+  }
+  rng->state=i128_add(i128_mult(accMult,rng->state),accPlus);
+}
+void i128_pcgFill(i128_pcg* rng,i128* out,size_t count){
+  for(size_t i=0;i<count;i++){
+    out[i]=i128_pcgNext(rng);
+  }
+}
+void i128_pcgFillBounded(i128_pcg* rng,i128 bound,i128* out,size_t count){
+  for(size_t i=0;i<count;i++){
+    out[i]=i128_pcgBounded(rng,bound);
+  }
+}
+
+// number theory
+
+static i128 i128_abs(i128 x){
+  return (x.hi&I64_HI_BIT)?i128_negate(x):x;
+}
+static i128 i128_fromI64(int64_t x){
+  return (i128){
+    .hi=x<0?I64_MAX:0,
+    .low=(uint64_t)x
+  };
+}
+
+// divides [hi:low] by d, requires hi < d
+// ( Hacker's Delight, divlu )
+static uint64_t i128_divMod64(uint64_t hi,uint64_t low,uint64_t d,uint64_t* rem){
+  // normalize divisor
+  int shift=64-i64_highestSetBit(d);
+  d<<=shift;
+  if(shift>0){
+    hi=(hi<<shift)|(low>>(64-shift));
+    low<<=shift;
+  }
+  uint64_t dHi=d>>32,dLow=d&I32_MASK;
+  uint64_t low1=low>>32,low0=low&I32_MASK;
+  uint64_t q1=hi/dHi,r=hi-q1*dHi;
+  while(q1>I32_MASK||q1*dLow>((r<<32)|low1)){
+    q1--;
+    r+=dHi;
+    if(r>I32_MASK)
+      break;
+  }
+  uint64_t t=(hi<<32)+low1-q1*d;
+  uint64_t q0=t/dHi;
+  r=t-q0*dHi;
+  while(q0>I32_MASK||q0*dLow>((r<<32)|low0)){
+    q0--;
+    r+=dHi;
+    if(r>I32_MASK)
+      break;
+  }
+  if(rem!=NULL){
+    *rem=((t<<32)+low0-q0*d)>>shift;
+  }
+  return (q1<<32)|q0;
+}
+
+// greatest common divisor of unsigned a and b
+// Lehmer's algorithm ( see i128_extendedGcd ) without the coefficients
+static i128 i128_unsignedGcd(i128 a,i128 b){
+  if(i128_unsignedCompare(a,b)<0){
+    i128 t=a;
+    a=b;
+    b=t;
+  }
+  while(a.hi!=0&&(b.hi|b.low)!=0){
+    int shift=i128_highestSetBit(a)-62;
+    int64_t ah=(int64_t)i128_logicalRightShift(a,shift).low;
+    int64_t bh=(int64_t)i128_logicalRightShift(b,shift).low;
+    int64_t A=1,B=0,C=0,D=1;
+    while(bh+C>0&&bh+D>0&&ah+A>=0&&ah+B>=0){
+      int64_t q=(ah+A)/(bh+C);
+      if(q!=(ah+B)/(bh+D))
+        break;
+      int64_t t=A-q*C;
+      A=C;
+      C=t;
+      t=B-q*D;
+      B=D;
+      D=t;
+      t=ah-q*bh;
+      ah=bh;
+      bh=t;
+    }
+    if(B==0){
+      // no step could be simulated, do one full division step
+      i128 r;
+      i128_unsignedDivMod(a,b,&r);
+      a=b;
+      b=r;
+    }else{
+      i128 t=i128_add(i128_mult(i128_fromI64(A),a),i128_mult(i128_fromI64(B),b));
+      b=i128_add(i128_mult(i128_fromI64(C),a),i128_mult(i128_fromI64(D),b));
+      a=t;
+    }
+  }
+  if((b.hi|b.low)==0)
+    return a;
+  // remaining steps with 64-bit division
+  uint64_t x=a.low,y=b.low;
+  while(y!=0){
+    uint64_t r=x%y;
+    x=y;
+    y=r;
+  }
+  return (i128){.hi=0,.low=x};
+}
+// greatest common divisor of |a| and |b|
+i128 i128_gcd(i128 a,i128 b){
+  return i128_unsignedGcd(i128_abs(a),i128_abs(b));
+}
+// returns g=gcd(a,b) and stores x,y with a*x+b*y=g (if not NULL)
+// Lehmer's algorithm: euclidean steps are simulated on the leading 62 bits,
+// the full numbers are updated once per batch of steps
+i128 i128_extendedGcd(i128 a,i128 b,i128* x,i128* y){
+  i128 u=i128_abs(a),v=i128_abs(b);
+  // u = |a|*x0 + |b|*y0, v = |a|*x1 + |b|*y1
+  i128 x0={.hi=0,.low=1},y0={.hi=0,.low=0},x1={.hi=0,.low=0},y1={.hi=0,.low=1};
+  if(i128_unsignedCompare(u,v)<0){
+    i128 t=u;
+    u=v;
+    v=t;
+    x0=y1=(i128){.hi=0,.low=0};
+    x1=y0=(i128){.hi=0,.low=1};
+  }
+  while(u.hi!=0&&(v.hi|v.low)!=0){
+    int shift=i128_highestSetBit(u)-62;
+    int64_t uh=(int64_t)i128_logicalRightShift(u,shift).low;
+    int64_t vh=(int64_t)i128_logicalRightShift(v,shift).low;
+    int64_t A=1,B=0,C=0,D=1;
+    while(vh+C>0&&vh+D>0&&uh+A>=0&&uh+B>=0){
+      int64_t q=(uh+A)/(vh+C);
+      if(q!=(uh+B)/(vh+D))
+        break;
+      int64_t t=A-q*C;
+      A=C;
+      C=t;
+      t=B-q*D;
+      B=D;
+      D=t;
+      t=uh-q*vh;
+      uh=vh;
+      vh=t;
+    }
+    i128 t;
+    if(B==0){
+      // no step could be simulated, do one full division step
+      i128 r;
+      i128 q=i128_unsignedDivMod(u,v,&r);
+      u=v;
+      v=r;
+      t=i128_sub(x0,i128_mult(q,x1));
+      x0=x1;
+      x1=t;
+      t=i128_sub(y0,i128_mult(q,y1));
+      y0=y1;
+      y1=t;
+    }else{
+      i128 a0=i128_fromI64(A),b0=i128_fromI64(B),c0=i128_fromI64(C),d0=i128_fromI64(D);
+      t=i128_add(i128_mult(a0,u),i128_mult(b0,v));
+      v=i128_add(i128_mult(c0,u),i128_mult(d0,v));
+      u=t;
+      t=i128_add(i128_mult(a0,x0),i128_mult(b0,x1));
+      x1=i128_add(i128_mult(c0,x0),i128_mult(d0,x1));
+      x0=t;
+      t=i128_add(i128_mult(a0,y0),i128_mult(b0,y1));
+      y1=i128_add(i128_mult(c0,y0),i128_mult(d0,y1));
+      y0=t;
+    }
+  }
+  // remaining steps with 64-bit division
+  while(v.low!=0){
+    i128 q={.hi=0,.low=u.low/v.low};
+    uint64_t r=u.low%v.low;
+    u=v;
+    v.low=r;
+    i128 t=i128_sub(x0,i128_mult(q,x1));
+    x0=x1;
+    x1=t;
+    t=i128_sub(y0,i128_mult(q,y1));
+    y0=y1;
+    y1=t;
+  }
+  if(x!=NULL){
+    *x=(a.hi&I64_HI_BIT)?i128_negate(x0):x0;
+  }
+  if(y!=NULL){
+    *y=(b.hi&I64_HI_BIT)?i128_negate(y0):y0;
+  }
+  return u;
+}
+// inverse of a modulo m (m>0), returns false if a and m are not coprime
+bool i128_modInverse(i128 a,i128 m,i128* inverse){
+  i128 r;
+  i128_divMod(a,m,&r);
+  if(r.hi&I64_HI_BIT){
+    r=i128_add(r,m);
+  }
+  i128 x;
+  i128 g=i128_extendedGcd(r,m,&x,NULL);
+  if(g.hi!=0||g.low!=1)
+    return false;
+  if(x.hi&I64_HI_BIT){
+    x=i128_add(x,m);
+  }
+  *inverse=x;
+  return true;
+}
+// floor(sqrt(x)) for unsigned x
+// newton iteration starting at an estimate from double precision sqrt
+i128 i128_sqrt(i128 x){
+  if(x.hi==0&&x.low<2)
+    return x;
+  union{
+    double f64;
+    uint64_t i64;
+  }d={.f64=(double)x.hi*18446744073709551616.0+(double)x.low};
+  double value=d.f64;
+  // halve exponent to get estimate within 6%, then newton iteration
+  d.i64=(d.i64>>1)+(0x3ff0000000000000ull>>1);
+  for(int i=0;i<4;i++){
+    d.f64=0.5*(d.f64+value/d.f64);
+  }
+  // start above the result, newton iteration decreases until it reaches floor(sqrt(x))
+  d.f64=d.f64*(1+0x1p-30)+1;
+  uint64_t s=d.f64>=18446744073709551615.0?I64_MAX:(uint64_t)d.f64;
+  // x.hi>=s only happens for s=2^64-1, which is then the result
+  while(x.hi<s){
+    uint64_t q=x.hi==0?x.low/s:i128_divMod64(x.hi,x.low,s,NULL);
+    uint64_t t=(s>>1)+(q>>1)+(s&q&1);
+    if(t>=s)
+      break;
+    s=t;
+  }
+  return (i128){.hi=0,.low=s};
+}
+// base^exp using exponentiation by squaring,
+// sets overflow (if not NULL) if the result does not fit in a signed 128-bit integer
+i128 i128_pow(i128 base,unsigned int exp,bool* overflow){
+  bool negative=(base.hi&I64_HI_BIT)&&(exp&1);
+  bool of=false;
+  i128 b=i128_abs(base),r={.hi=0,.low=1},hi;
+  while(exp!=0){
+    if(exp&1){
+      r=i128_bigMult(r,b,&hi);
+      of|=(hi.hi|hi.low)!=0;
+    }
+    exp>>=1;
+    if(exp!=0){
+      b=i128_bigMult(b,b,&hi);
+      of|=(hi.hi|hi.low)!=0;
+    }
+  }
+  if(r.hi&I64_HI_BIT){
+    // only -2^127 is in range
+    of|=!(negative&&r.hi==I64_HI_BIT&&r.low==0);
+  }
+  if(overflow!=NULL){
+    *overflow=of;
+  }
+  return negative?i128_negate(r):r;
+}
+
+// reference versions using only i128_unsignedDivMod and i128_mult, used by i128_numberTheoryBenchmark
+static i128 i128_divModGcd(i128 u,i128 v){
+  while((v.hi|v.low)!=0){
+    i128 r;
+    i128_unsignedDivMod(u,v,&r);
+    u=v;
+    v=r;
+  }
+  return u;
+}
+static i128 i128_divModExtendedGcd(i128 u,i128 v,i128* x){
+  i128 x0={.hi=0,.low=1},x1={.hi=0,.low=0};
+  while((v.hi|v.low)!=0){
+    i128 r;
+    i128 q=i128_unsignedDivMod(u,v,&r);
+    u=v;
+    v=r;
+    i128 t=i128_sub(x0,i128_mult(q,x1));
+    x0=x1;
+    x1=t;
+  }
+  *x=x0;
+  return u;
+}
+static i128 i128_divModSqrt(i128 x){
+  if(x.hi==0&&x.low<2)
+    return x;
+  // start above the result at 2^ceil(bits/2)
+  i128 s=i128_leftShift((i128){.hi=0,.low=1},(i128_highestSetBit(x)+2)/2);
+  while(true){
+    i128 q=i128_unsignedDivMod(x,s,NULL);
+    i128 t=i128_logicalRightShift(i128_add(s,q),1);
+    if(i128_unsignedCompare(t,s)>=0)
+      return s;
+    s=t;
+  }
+}
+// repeated multiplication, overflow is detected by dividing the largest value by the factor
+static i128 i128_divModPow(i128 base,unsigned int exp,bool* overflow){
+  i128 max={.hi=I64_HI_BIT-1,.low=I64_MAX},r={.hi=0,.low=1};
+  *overflow=false;
+  for(unsigned int i=0;i<exp;i++){
+    if((base.hi|base.low)!=0&&i128_unsignedCompare(r,i128_unsignedDivMod(max,base,NULL))>0)
+      *overflow=true;
+    r=i128_mult(r,base);
+  }
+  return r;
+}
+// prints time per call of i128_gcd, i128_extendedGcd, i128_sqrt and i128_pow compared with the reference versions
+// for count random positive operands and the number of differing results,
+// returns false if memory allocation failed
+bool i128_numberTheoryBenchmark(size_t count,FILE* out){
+  i128* a=malloc(2*count*sizeof(i128));
+  i128* r=malloc(2*count*sizeof(i128));
+  unsigned int* exps=malloc(count*sizeof(unsigned int));
+  if(a==NULL||r==NULL||exps==NULL){
+    free(a);
+    free(r);
+    free(exps);
+    return false;
+  }
+  i128* b=a+count;
+  i128* reference=r+count;
+  i128_pcg rng;
+  i128_pcgSeed(&rng,(i128){.hi=0,.low=42},(i128){.hi=0,.low=54});
+  for(size_t i=0;i<count;i++){
+    a[i]=i128_pcgNext(&rng);
+    a[i].hi>>=1;
+    b[i]=i128_pcgNext(&rng);
+    b[i].hi>>=1;
+    exps[i]=(unsigned int)(b[i].low%40);
+  }
+  const char* names[4]={"gcd","extendedGcd","sqrt","pow"};
+  fprintf(out,"%-12s %8s %14s %8s %6s\n","op","ns/call","divMod ns/call","speedup","diffs");
+  for(int op=0;op<4;op++){
+    double seconds[2];
+    for(int version=0;version<2;version++){
+      i128* results=version==0?r:reference;
+      clock_t start=clock();
+      for(size_t i=0;i<count;i++){
+        bool of;
+        i128 x;
+        switch(op){
+          case 0:
+            results[i]=version==0?i128_gcd(a[i],b[i]):i128_divModGcd(a[i],b[i]);
+            break;
+          case 1:
+            if(version==0){
+              i128_extendedGcd(a[i],b[i],&x,NULL);
+            }else{
+              i128_divModExtendedGcd(a[i],b[i],&x);
+            }
+            results[i]=x;
+            break;
+          case 2:
+            results[i]=version==0?i128_sqrt(a[i]):i128_divModSqrt(a[i]);
+            break;
+          default:
+            // small bases such that some powers do not overflow
+            x=(i128){.hi=0,.low=a[i].low>>48};
+            results[i]=version==0?i128_pow(x,exps[i],&of):i128_divModPow(x,exps[i],&of);
+            if(of)
+              results[i]=(i128){.hi=0,.low=0};
+            break;
+        }
+      }
+      seconds[version]=(double)(clock()-start)/CLOCKS_PER_SEC;
+    }
+    size_t diffs=0;
+    for(size_t i=0;i<count;i++){
+      diffs+=r[i].hi!=reference[i].hi||r[i].low!=reference[i].low;
+    }
+    fprintf(out,"%-12s %8.1f %14.1f %8.1f %6zu\n",names[op],seconds[0]*1e9/(double)count,
+      seconds[1]*1e9/(double)count,seconds[0]>0?seconds[1]/seconds[0]:0.0,diffs);
+  }
+  free(a);
+  free(r);
+  free(exps);
+  return true;
+}
+
+// prefix sums
+// the scans start at a given offset ( carry for segmented scans ), such that large arrays can be
+// processed in two passes over independent blocks ( e.g. by different threads ):
+// 1. sum each block ( i128_sum, i128_segmentedSum, i128_segmentedSumByKey )
+// 2. the offset of each block is the exclusive scan of the block sums,
+//    for segmented scans the carry of block b+1 is element b of i128_segmentedScan
+//    applied to the block sums with the restart flags of the blocks
+// 3. scan each block starting at its offset, scans by key continue the last key of the preceding block
+// overflow (if not NULL) is set if any running sum is out of range, the results wrap around
+
+// a+b, accumulates the overflow flag in the highest bit of of
+static i128 i128_addChecked(i128 a,i128 b,uint64_t* of){
+  i128 r=i128_add(a,b);
+  *of|=~(a.hi^b.hi)&(a.hi^r.hi);
+  return r;
+}
+// sum of all values, sets overflow (if not NULL) if an intermediate sum is out of range
+i128 i128_sum(const i128* values,size_t count,bool* overflow){
+  i128 sum={.hi=0,.low=0};
+  uint64_t of=0;
+  for(size_t i=0;i<count;i++){
+    sum=i128_addChecked(sum,values[i],&of);
+  }
+  if(overflow!=NULL){
+    *overflow=of>>63;
+  }
+  return sum;
+}
+// out[i]=offset+values[0]+...+values[i], returns offset+sum of all values
+// out may be the same array as values
+i128 i128_inclusiveScan(const i128* values,i128* out,size_t count,i128 offset,bool* overflow){
+  uint64_t of=0;
+  for(size_t i=0;i<count;i++){
+    offset=i128_addChecked(offset,values[i],&of);
+    out[i]=offset;
+  }
+  if(overflow!=NULL){
+    *overflow=of>>63;
+  }
+  return offset;
+}
+// out[i]=offset+values[0]+...+values[i-1], returns offset+sum of all values
+// out may be the same array as values
+i128 i128_exclusiveScan(const i128* values,i128* out,size_t count,i128 offset,bool* overflow){
+  uint64_t of=0;
+  for(size_t i=0;i<count;i++){
+    i128 value=values[i];
+    out[i]=offset;
+    offset=i128_addChecked(offset,value,&of);
+  }
+  if(overflow!=NULL){
+    *overflow=of>>63;
+  }
+  return offset;
+}
+// inclusive scan that restarts at every element with starts[i] set,
+// carry is added to the elements before the first restart, returns the last running sum
+i128 i128_segmentedScan(const i128* values,const bool* starts,i128* out,size_t count,i128 carry,bool* overflow){
+  uint64_t of=0;
+  for(size_t i=0;i<count;i++){
+    uint64_t keep=(uint64_t)starts[i]-1;// all ones if the sum continues
+    carry.hi&=keep;
+    carry.low&=keep;
+    carry=i128_addChecked(carry,values[i],&of);
+    out[i]=carry;
+  }
+  if(overflow!=NULL){
+    *overflow=of>>63;
+  }
+  return carry;
+}
+// sum of the elements after the last restart ( including the restarting element ),
+// sets restarted if any element of starts is set
+i128 i128_segmentedSum(const i128* values,const bool* starts,size_t count,bool* restarted,bool* overflow){
+  i128 sum={.hi=0,.low=0};
+  uint64_t of=0;
+  bool any=false;
+  for(size_t i=0;i<count;i++){
+    uint64_t keep=(uint64_t)starts[i]-1;
+    any|=starts[i];
+    sum.hi&=keep;
+    sum.low&=keep;
+    sum=i128_addChecked(sum,values[i],&of);
+  }
+  *restarted=any;
+  if(overflow!=NULL){
+    *overflow=of>>63;
+  }
+  return sum;
+}
+// inclusive scan that restarts whenever the key changes,
+// carry is the running sum of the group with key carryKey preceding the array
+i128 i128_segmentedScanByKey(const i128* values,const uint64_t* keys,i128* out,size_t count,uint64_t carryKey,i128 carry,bool* overflow){
+  uint64_t of=0;
+  for(size_t i=0;i<count;i++){
+    uint64_t keep=0-(uint64_t)(keys[i]==carryKey);
+    carryKey=keys[i];
+    carry.hi&=keep;
+    carry.low&=keep;
+    carry=i128_addChecked(carry,values[i],&of);
+    out[i]=carry;
+  }
+  if(overflow!=NULL){
+    *overflow=of>>63;
+  }
+  return carry;
+}
+// sum of the last group of keys, sets restarted if any key differs from the preceding key
+// ( previousKey for the first element )
+i128 i128_segmentedSumByKey(const i128* values,const uint64_t* keys,size_t count,uint64_t previousKey,bool* restarted,bool* overflow){
+  i128 sum={.hi=0,.low=0};
+  uint64_t of=0;
+  bool any=false;
+  for(size_t i=0;i<count;i++){
+    bool start=keys[i]!=previousKey;
+    uint64_t keep=(uint64_t)start-1;
+    previousKey=keys[i];
+    any|=start;
+    sum.hi&=keep;
+    sum.low&=keep;
+    sum=i128_addChecked(sum,values[i],&of);
+  }
+  *restarted=any;
+  if(overflow!=NULL){
+    *overflow=of>>63;
+  }
+  return sum;
+}
+
+// block drivers for the scans, split the array into the given number of blocks and run the three passes above,
+// the results ( including the overflow flag ) are the same as for the scan of the whole array,
+// compile with -DI128_SCAN_THREADS ( and -pthread ) to process the blocks of each pass in separate threads
+
+typedef enum{
+  I128_SCAN_INCLUSIVE,
+  I128_SCAN_EXCLUSIVE,
+  I128_SCAN_SEGMENTED,
+  I128_SCAN_BY_KEY
+}i128_scanKind;
+
+typedef struct{
+  i128_scanKind kind;
+  bool scan;// false for the first pass ( block sum ), true for the last pass ( scan )
+  const i128* values;
+  const bool* starts;
+  const uint64_t* keys;
+  i128* out;
+  size_t count;
+  uint64_t carryKey;// key preceding the block
+  i128 carry;// offset or carry of the block for the last pass, block sum after the first pass
+  bool restarted;
+  bool overflow;
+}i128_scanBlock;
+
+static void* i128_scanBlockPass(void* arg){
+  i128_scanBlock* b=arg;
+  if(!b->scan){
+    switch(b->kind){
+      case I128_SCAN_INCLUSIVE:
+      case I128_SCAN_EXCLUSIVE:
+        b->carry=i128_sum(b->values,b->count,NULL);
+        break;
+      case I128_SCAN_SEGMENTED:
+        b->carry=i128_segmentedSum(b->values,b->starts,b->count,&b->restarted,NULL);
+        break;
+      case I128_SCAN_BY_KEY:
+        b->carry=i128_segmentedSumByKey(b->values,b->keys,b->count,b->carryKey,&b->restarted,NULL);
+        break;
+    }
+    return NULL;
+  }
+  switch(b->kind){
+    case I128_SCAN_INCLUSIVE:
+      b->carry=i128_inclusiveScan(b->values,b->out,b->count,b->carry,&b->overflow);
+      break;
+    case I128_SCAN_EXCLUSIVE:
+      b->carry=i128_exclusiveScan(b->values,b->out,b->count,b->carry,&b->overflow);
+      break;
+    case I128_SCAN_SEGMENTED:
+      b->carry=i128_segmentedScan(b->values,b->starts,b->out,b->count,b->carry,&b->overflow);
+      break;
+    case I128_SCAN_BY_KEY:
+      b->carry=i128_segmentedScanByKey(b->values,b->keys,b->out,b->count,b->carryKey,b->carry,&b->overflow);
+      break;
+  }
+  return NULL;
+}
+// run the current pass on all blocks
+static void i128_scanBlocksPass(i128_scanBlock* blocks,size_t count){
+#ifdef I128_SCAN_THREADS
+  pthread_t* threads=malloc(count*sizeof(pthread_t));
+  bool* started=calloc(count,sizeof(bool));
+  if(threads!=NULL&&started!=NULL){
+    // the first block runs on the calling thread, blocks without a thread as well
+    for(size_t b=1;b<count;b++){
+      started[b]=pthread_create(&threads[b],NULL,i128_scanBlockPass,&blocks[b])==0;
+    }
+    for(size_t b=0;b<count;b++){
+      if(!started[b]){
+        i128_scanBlockPass(&blocks[b]);
+      }
+    }
+    for(size_t b=1;b<count;b++){
+      if(started[b]){
+        pthread_join(threads[b],NULL);
+      }
+    }
+    free(threads);
+    free(started);
+    return;
+  }
+  free(threads);
+  free(started);
+#endif
+  for(size_t b=0;b<count;b++){
+    i128_scanBlockPass(&blocks[b]);
+  }
+}
+// returns false if the memory for the blocks cannot be allocated
+static bool i128_scanBlocked(i128_scanKind kind,const i128* values,const bool* starts,const uint64_t* keys,i128* out,
+    size_t count,uint64_t carryKey,i128 carry,size_t blockCount,i128* result,bool* overflow){
+  if(blockCount>count)
+    blockCount=count;
+  if(blockCount==0)
+    blockCount=1;
+  i128_scanBlock* blocks=malloc(blockCount*sizeof(i128_scanBlock));
+  if(blocks==NULL)
+    return false;
+  for(size_t b=0;b<blockCount;b++){
+    size_t start=count/blockCount*b+(b<count%blockCount?b:count%blockCount);
+    blocks[b]=(i128_scanBlock){
+      .kind=kind,
+      .scan=false,
+      .values=values+start,
+      .starts=starts==NULL?NULL:starts+start,
+      .keys=keys==NULL?NULL:keys+start,
+      .out=out+start,
+      .count=count/blockCount+(b<count%blockCount),
+      .carryKey=keys==NULL||b==0?carryKey:keys[start-1]
+    };
+  }
+  // first pass, all block sums are computed before any block is written ( out may be the same array as values )
+  i128_scanBlocksPass(blocks,blockCount);
+  // second pass, offset or carry of each block
+  for(size_t b=0;b<blockCount;b++){
+    i128 sum=blocks[b].carry;
+    bool restarted=blocks[b].restarted;
+    blocks[b].carry=carry;
+    blocks[b].scan=true;
+    if(restarted){
+      carry=sum;
+    }else{
+      carry=i128_add(carry,sum);
+    }
+  }
+  // last pass
+  i128_scanBlocksPass(blocks,blockCount);
+  bool of=false;
+  for(size_t b=0;b<blockCount;b++){
+    of|=blocks[b].overflow;
+  }
+  *result=blocks[blockCount-1].carry;
+  if(overflow!=NULL){
+    *overflow=of;
+  }
+  free(blocks);
+  return true;
+}
+// same results as the scans without blocks, blocks is the number of blocks ( falls back to the sequential scan
+// if the memory for the blocks cannot be allocated )
+i128 i128_inclusiveScanBlocked(const i128* values,i128* out,size_t count,i128 offset,size_t blocks,bool* overflow){
+  i128 r;
+  if(i128_scanBlocked(I128_SCAN_INCLUSIVE,values,NULL,NULL,out,count,0,offset,blocks,&r,overflow))
+    return r;
+  return i128_inclusiveScan(values,out,count,offset,overflow);
+}
+i128 i128_exclusiveScanBlocked(const i128* values,i128* out,size_t count,i128 offset,size_t blocks,bool* overflow){
+  i128 r;
+  if(i128_scanBlocked(I128_SCAN_EXCLUSIVE,values,NULL,NULL,out,count,0,offset,blocks,&r,overflow))
+    return r;
+  return i128_exclusiveScan(values,out,count,offset,overflow);
+}
+i128 i128_segmentedScanBlocked(const i128* values,const bool* starts,i128* out,size_t count,i128 carry,size_t blocks,bool* overflow){
+  i128 r;
+  if(i128_scanBlocked(I128_SCAN_SEGMENTED,values,starts,NULL,out,count,0,carry,blocks,&r,overflow))
+    return r;
+  return i128_segmentedScan(values,starts,out,count,carry,overflow);
+}
+i128 i128_segmentedScanByKeyBlocked(const i128* values,const uint64_t* keys,i128* out,size_t count,uint64_t carryKey,i128 carry,size_t blocks,bool* overflow){
+  i128 r;
+  if(i128_scanBlocked(I128_SCAN_BY_KEY,values,NULL,keys,out,count,carryKey,carry,blocks,&r,overflow))
+    return r;
+  return i128_segmentedScanByKey(values,keys,out,count,carryKey,carry,overflow);
+}
+
+// fixed point decimals
+
+// powers of ten 10^0 ... 10^38
+static const i128 I128_POW10[DEC128_MAX_SCALE+1]={
+  {.hi=0x0000000000000000ull,.low=0x0000000000000001ull},
+  {.hi=0x0000000000000000ull,.low=0x000000000000000aull},
+  {.hi=0x0000000000000000ull,.low=0x0000000000000064ull},
+  {.hi=0x0000000000000000ull,.low=0x00000000000003e8ull},
+  {.hi=0x0000000000000000ull,.low=0x0000000000002710ull},
+  {.hi=0x0000000000000000ull,.low=0x00000000000186a0ull},
+  {.hi=0x0000000000000000ull,.low=0x00000000000f4240ull},
+  {.hi=0x0000000000000000ull,.low=0x0000000000989680ull},
+  {.hi=0x0000000000000000ull,.low=0x0000000005f5e100ull},
+  {.hi=0x0000000000000000ull,.low=0x000000003b9aca00ull},
+  {.hi=0x0000000000000000ull,.low=0x00000002540be400ull},
+  {.hi=0x0000000000000000ull,.low=0x000000174876e800ull},
+  {.hi=0x0000000000000000ull,.low=0x000000e8d4a51000ull},
+  {.hi=0x0000000000000000ull,.low=0x000009184e72a000ull},
+  {.hi=0x0000000000000000ull,.low=0x00005af3107a4000ull},
+  {.hi=0x0000000000000000ull,.low=0x00038d7ea4c68000ull},
+  {.hi=0x0000000000000000ull,.low=0x002386f26fc10000ull},
+  {.hi=0x0000000000000000ull,.low=0x016345785d8a0000ull},
+  {.hi=0x0000000000000000ull,.low=0x0de0b6b3a7640000ull},
+  {.hi=0x0000000000000000ull,.low=0x8ac7230489e80000ull},
+  {.hi=0x0000000000000005ull,.low=0x6bc75e2d63100000ull},
+  {.hi=0x0000000000000036ull,.low=0x35c9adc5dea00000ull},
+  {.hi=0x000000000000021eull,.low=0x19e0c9bab2400000ull},
+  {.hi=0x000000000000152dull,.low=0x02c7e14af6800000ull},
+  {.hi=0x000000000000d3c2ull,.low=0x1bcecceda1000000ull},
+  {.hi=0x0000000000084595ull,.low=0x161401484a000000ull},
+  {.hi=0x000000000052b7d2ull,.low=0xdcc80cd2e4000000ull},
+  {.hi=0x00000000033b2e3cull,.low=0x9fd0803ce8000000ull},
+  {.hi=0x00000000204fce5eull,.low=0x3e25026110000000ull},
+  {.hi=0x00000001431e0faeull,.low=0x6d7217caa0000000ull},
+  {.hi=0x0000000c9f2c9cd0ull,.low=0x4674edea40000000ull},
+  {.hi=0x0000007e37be2022ull,.low=0xc0914b2680000000ull},
+  {.hi=0x000004ee2d6d415bull,.low=0x85acef8100000000ull},
+  {.hi=0x0000314dc6448d93ull,.low=0x38c15b0a00000000ull},
+  {.hi=0x0001ed09bead87c0ull,.low=0x378d8e6400000000ull},
+  {.hi=0x0013426172c74d82ull,.low=0x2b878fe800000000ull},
+  {.hi=0x00c097ce7bc90715ull,.low=0xb34b9f1000000000ull},
+  {.hi=0x0785ee10d5da46d9ull,.low=0x00f436a000000000ull},
+  {.hi=0x4b3b4ca85a86c47aull,.low=0x098a224000000000ull},
+};
+#define DEC128_CHUNK_DIGITS 9
+#define DEC128_LIMBS 8
+
+// splits 256-bit unsigned integer into 32-bit limbs (least significant first)
+static void dec128_toLimbs(i128 hi,i128 low,uint32_t* limbs){
+  uint64_t words[4]={low.low,low.hi,hi.low,hi.hi};
+  for(int i=0;i<4;i++){
+    limbs[2*i]=(uint32_t)words[i];
+    limbs[2*i+1]=(uint32_t)(words[i]>>32);
+  }
+}
+// divides limbs by d in place, returns remainder
+static uint32_t dec128_divSmall(uint32_t* limbs,int n,uint32_t d){
+  uint64_t r=0;
+  for(int i=n-1;i>=0;i--){
+    uint64_t cur=(r<<32)|limbs[i];
+    limbs[i]=(uint32_t)(cur/d);
+    r=cur%d;
+  }
+  return (uint32_t)r;
+}
+static void dec128_increment(uint32_t* limbs,int n){
+  for(int i=0;i<n;i++){
+    if(++limbs[i]!=0)
+      break;
+  }
+}
+// converts magnitude to signed value, sets overflow if it is out of range
+static i128 dec128_fromMagnitude(const uint32_t* limbs,bool negative,bool* overflow){
+  for(int i=4;i<DEC128_LIMBS;i++){
+    if(limbs[i]!=0){
+      *overflow=true;
+    }
+  }
+  i128 r={
+    .hi=((uint64_t)limbs[3]<<32)|limbs[2],
+    .low=((uint64_t)limbs[1]<<32)|limbs[0]
+  };
+  if(r.hi&I64_HI_BIT){
+    // only -2^127 is in range
+    if(!(negative&&r.hi==I64_HI_BIT&&r.low==0)){
+      *overflow=true;
+    }
+  }
+  return negative?i128_negate(r):r;
+}
+// divides magnitude by 10^k, rounding ties to even
+// the division is done in steps of 10^9 so that each step only needs 32-bit divisors
+static void dec128_roundDivPow10(uint32_t* limbs,unsigned int k){
+  i128 rem={.hi=0,.low=0};
+  unsigned int done=0;
+  while(done<k){
+    unsigned int step=k-done>DEC128_CHUNK_DIGITS?DEC128_CHUNK_DIGITS:k-done;
+    uint32_t r=dec128_divSmall(limbs,DEC128_LIMBS,(uint32_t)I128_POW10[step].low);
+    // total remainder: r*10^done + previous remainder
+    rem=i128_add(rem,i128_mult((i128){.hi=0,.low=r},I128_POW10[done]));
+    done+=step;
+  }
+  if(k==0)
+    return;
+  // compare 2*rem with 10^k (10^k<2^127, no overflow)
+  int c=i128_unsignedCompare(i128_leftShift(rem,1),I128_POW10[k]);
+  if(c>0||(c==0&&(limbs[0]&1))){
+    dec128_increment(limbs,DEC128_LIMBS);
+  }
+}
+// Knuth algorithm D on 32-bit limbs ( Hacker's Delight, divmnu )
+// u has m limbs, v has n limbs with v[n-1]!=0 and 2<=n<=m<=DEC128_LIMBS
+// stores m-n+1 quotient limbs in q and n remainder limbs in r
+static void dec128_divLong(const uint32_t* u,int m,const uint32_t* v,int n,uint32_t* q,uint32_t* r){
+  uint32_t un[DEC128_LIMBS+1],vn[DEC128_LIMBS];
+  // normalize so that highest bit of divisor is set
+  int shift=32-i64_highestSetBit(v[n-1]);
+  for(int i=n-1;i>0;i--){
+    vn[i]=(uint32_t)((((uint64_t)v[i]<<32)|v[i-1])>>(32-shift));
+  }
+  vn[0]=v[0]<<shift;
+  un[m]=(uint32_t)((uint64_t)u[m-1]>>(32-shift));
+  for(int i=m-1;i>0;i--){
+    un[i]=(uint32_t)((((uint64_t)u[i]<<32)|u[i-1])>>(32-shift));
+  }
+  un[0]=u[0]<<shift;
+  for(int j=m-n;j>=0;j--){
+    // estimate quotient digit from leading limbs
+    uint64_t top=((uint64_t)un[j+n]<<32)|un[j+n-1];
+    uint64_t qhat=top/vn[n-1];
+    uint64_t rhat=top-qhat*vn[n-1];
+    while(qhat>I32_MASK||qhat*vn[n-2]>((rhat<<32)|un[j+n-2])){
+      qhat--;
+      rhat+=vn[n-1];
+      if(rhat>I32_MASK)
+        break;
+    }
+    // multiply and subtract
+    uint64_t borrow=0;
+    for(int i=0;i<n;i++){
+      uint64_t p=qhat*vn[i]+borrow;
+      borrow=(p>>32)+(un[i+j]<(uint32_t)p);
+      un[i+j]-=(uint32_t)p;
+    }
+    bool negative=un[j+n]<borrow;
+    un[j+n]-=(uint32_t)borrow;
+    if(negative){
+      // estimate was one too large, add back
+      qhat--;
+      uint64_t carry=0;
+      for(int i=0;i<n;i++){
+        uint64_t s=(uint64_t)un[i+j]+vn[i]+carry;
+        un[i+j]=(uint32_t)s;
+        carry=s>>32;
+      }
+      un[j+n]+=(uint32_t)carry;
+    }
+    q[j]=(uint32_t)qhat;
+  }
+  for(int i=0;i<n;i++){
+    r[i]=(uint32_t)((((uint64_t)un[i+1]<<32)|un[i])>>shift);
+  }
+}
+// divides 256-bit unsigned value in u by d ( d!=0 ),
+// stores quotient in q and returns remainder
+static i128 dec128_divLimbs(const uint32_t* u,i128 d,uint32_t* q){
+  uint32_t v[4]={(uint32_t)d.low,(uint32_t)(d.low>>32),(uint32_t)d.hi,(uint32_t)(d.hi>>32)};
+  uint32_t rem[4]={0};
+  int n=4;
+  while(v[n-1]==0){
+    n--;
+  }
+  if(n==1){
+    memcpy(q,u,DEC128_LIMBS*sizeof(uint32_t));
+    rem[0]=dec128_divSmall(q,DEC128_LIMBS,v[0]);
+  }else{
+    memset(q,0,DEC128_LIMBS*sizeof(uint32_t));
+    dec128_divLong(u,DEC128_LIMBS,v,n,q,rem);
+  }
+  return (i128){
+    .hi=((uint64_t)rem[3]<<32)|rem[2],
+    .low=((uint64_t)rem[1]<<32)|rem[0]
+  };
+}
+// scales above DEC128_MAX_SCALE set overflow and give zero ( false in dec128_parse, an empty string in dec128_format )
+static bool dec128_validScale(unsigned int scale){
+  return scale<=DEC128_MAX_SCALE;
+}
+// a+b, sets overflow (if not NULL) if the result is out of range
+dec128 dec128_add(dec128 a,dec128 b,bool* overflow){
+  i128 r=i128_add(a,b);
+  if(overflow!=NULL){
+    // overflow iff both operands have the same sign and the result has a different sign
+    *overflow=(~(a.hi^b.hi)&(a.hi^r.hi))>>63;
+  }
+  return r;
+}
+// a-b, sets overflow (if not NULL) if the result is out of range
+dec128 dec128_sub(dec128 a,dec128 b,bool* overflow){
+  i128 r=i128_sub(a,b);
+  if(overflow!=NULL){
+    *overflow=((a.hi^b.hi)&(a.hi^r.hi))>>63;
+  }
+  return r;
+}
+// a*b for two values with the given scale, rounds ties to even
+dec128 dec128_mult(dec128 a,dec128 b,unsigned int scale,bool* overflow){
+  bool negative=(a.hi^b.hi)>>63,of=false;
+  if(!dec128_validScale(scale)){
+    if(overflow!=NULL){
+      *overflow=true;
+    }
+    return (i128){.hi=0,.low=0};
+  }
+  uint32_t limbs[DEC128_LIMBS];
+  i128 hi;
+  i128 low=i128_bigMult(i128_abs(a),i128_abs(b),&hi);
+  dec128_toLimbs(hi,low,limbs);
+  dec128_roundDivPow10(limbs,scale);
+  i128 r=dec128_fromMagnitude(limbs,negative,&of);
+  if(overflow!=NULL){
+    *overflow=of;
+  }
+  return r;
+}
+// a/b for two values with the given scale, rounds ties to even
+// division by zero sets overflow and returns zero
+dec128 dec128_div(dec128 a,dec128 b,unsigned int scale,bool* overflow){
+  bool negative=(a.hi^b.hi)>>63,of=false;
+  i128 d=i128_abs(b);
+  i128 r={.hi=0,.low=0};
+  if((d.hi|d.low)==0||!dec128_validScale(scale)){
+    of=true;
+  }else{
+    uint32_t u[DEC128_LIMBS],q[DEC128_LIMBS];
+    i128 hi;
+    i128 low=i128_bigMult(i128_abs(a),I128_POW10[scale],&hi);
+    dec128_toLimbs(hi,low,u);
+    i128 remainder=dec128_divLimbs(u,d,q);
+    // round up if remainder > d-remainder, ties to even
+    int c=i128_unsignedCompare(remainder,i128_sub(d,remainder));
+    if(c>0||(c==0&&(q[0]&1))){
+      dec128_increment(q,DEC128_LIMBS);
+    }
+    r=dec128_fromMagnitude(q,negative,&of);
+  }
+  if(overflow!=NULL){
+    *overflow=of;
+  }
+  return r;
+}
+// converts value from one scale to another, rounds ties to even when the scale is reduced
+dec128 dec128_rescale(dec128 value,unsigned int fromScale,unsigned int toScale,bool* overflow){
+  bool negative=value.hi>>63,of=false;
+  if(!(dec128_validScale(fromScale)&&dec128_validScale(toScale))){
+    if(overflow!=NULL){
+      *overflow=true;
+    }
+    return (i128){.hi=0,.low=0};
+  }
+  uint32_t limbs[DEC128_LIMBS];
+  i128 hi,low;
+  if(toScale>=fromScale){
+    low=i128_bigMult(i128_abs(value),I128_POW10[toScale-fromScale],&hi);
+  }else{
+    low=i128_abs(value);
+    hi=(i128){.hi=0,.low=0};
+  }
+  dec128_toLimbs(hi,low,limbs);
+  if(toScale<fromScale){
+    dec128_roundDivPow10(limbs,fromScale-toScale);
+  }
+  i128 r=dec128_fromMagnitude(limbs,negative,&of);
+  if(overflow!=NULL){
+    *overflow=of;
+  }
+  return r;
+}
+// appends count digits stored in chunk to magnitude, returns false on overflow
+static bool dec128_appendDigits(i128* magnitude,uint64_t chunk,int count){
+  i128 hi;
+  i128 r=i128_bigMult(*magnitude,I128_POW10[count],&hi);
+  r=i128_add(r,(i128){.hi=0,.low=chunk});
+  if((hi.hi|hi.low)!=0||i128_unsignedCompare(r,(i128){.hi=0,.low=chunk})<0)
+    return false;
+  *magnitude=r;
+  return true;
+}
+// parses decimal number of the form [+-]digits[.digits] with the given scale,
+// additional fractional digits are rounded ties to even
+// returns false if the string is not a valid number or the value is out of range
+bool dec128_parse(const char* str,unsigned int scale,dec128* value){
+  if(!dec128_validScale(scale))
+    return false;
+  bool negative=false;
+  if(*str=='-'||*str=='+'){
+    negative=*str=='-';
+    str++;
+  }
+  i128 magnitude={.hi=0,.low=0};
+  uint64_t chunk=0;
+  int chunkDigits=0;
+  unsigned int fracDigits=0;
+  bool digits=false,point=false;
+  // digits beyond scale: first dropped digit and whether any later digit is non-zero
+  int dropped=-1;
+  bool sticky=false;
+  for(;*str!='\0';str++){
+    if(*str=='.'&&!point){
+      point=true;
+      continue;
+    }
+    if(*str<'0'||*str>'9')
+      return false;
+    digits=true;
+    if(point&&fracDigits>=scale){
+      if(dropped<0){
+        dropped=*str-'0';
+      }else{
+        sticky|=*str!='0';
+      }
+      continue;
+    }
+    if(point){
+      fracDigits++;
+    }
+    // collect digits in 64-bit chunks to reduce number of 128-bit multiplications
+    chunk=chunk*10+(uint64_t)(*str-'0');
+    if(++chunkDigits==19){
+      if(!dec128_appendDigits(&magnitude,chunk,chunkDigits))
+        return false;
+      chunk=0;
+      chunkDigits=0;
+    }
+  }
+  if(!digits)
+    return false;
+  if(!dec128_appendDigits(&magnitude,chunk,chunkDigits))
+    return false;
+  if(fracDigits<scale&&!dec128_appendDigits(&magnitude,0,scale-fracDigits))
+    return false;
+  if(dropped>5||(dropped==5&&(sticky||(magnitude.low&1)))){
+    magnitude=i128_add(magnitude,(i128){.hi=0,.low=1});
+    if((magnitude.hi|magnitude.low)==0)
+      return false;
+  }
+  if(magnitude.hi&I64_HI_BIT){
+    if(!(negative&&magnitude.hi==I64_HI_BIT&&magnitude.low==0))
+      return false;
+  }
+  *value=negative?i128_negate(magnitude):magnitude;
+  return true;
+}
+// writes value with given scale as decimal string to buffer
+// (buffer needs at least DEC128_FORMAT_SIZE chars), returns length of string ( 0 for an invalid scale )
+size_t dec128_format(dec128 value,unsigned int scale,char* buffer){
+  if(!dec128_validScale(scale)){
+    buffer[0]='\0';
+    return 0;
+  }
+  char digits[DEC128_FORMAT_SIZE];
+  i128 magnitude=i128_abs(value);
+  int count=0;
+  // extract 19 digits at a time using 128/64-bit division
+  const uint64_t chunkBase=10000000000000000000ull;
+  while((magnitude.hi|magnitude.low)!=0){
+    uint64_t rem;
+    uint64_t qHi=magnitude.hi/chunkBase;
+    uint64_t qLow=i128_divMod64(magnitude.hi%chunkBase,magnitude.low,chunkBase,&rem);
+    magnitude=(i128){.hi=qHi,.low=qLow};
+    // no leading zeros in highest chunk
+    bool last=(magnitude.hi|magnitude.low)==0;
+    for(int i=0;i<19&&(!last||rem!=0);i++){
+      digits[count++]=(char)('0'+rem%10);
+      rem/=10;
+    }
+  }
+  // at least one digit before the decimal point
+  while(count<=(int)scale){
+    digits[count++]='0';
+  }
+  size_t length=0;
+  if(value.hi&I64_HI_BIT){
+    buffer[length++]='-';
+  }
+  for(int i=count-1;i>=0;i--){
+    buffer[length++]=digits[i];
+    if(i==(int)scale&&scale>0){
+      buffer[length++]='.';
+    }
+  }
+  buffer[length]='\0';
+  return length;
+}
+// out[i]=a[i]+b[i], sets overflow (if not NULL) if any sum is out of range
+void dec128_addArray(const dec128* a,const dec128* b,dec128* out,size_t count,bool* overflow){
+  uint64_t of=0;
+  for(size_t i=0;i<count;i++){
+    i128 r=i128_add(a[i],b[i]);
+    of|=~(a[i].hi^b[i].hi)&(a[i].hi^r.hi);
+    out[i]=r;
+  }
+  if(overflow!=NULL){
+    *overflow=of>>63;
+  }
+}
+// out[i]=a[i]*b[i], sets overflow (if not NULL) if any product is out of range
+void dec128_multArray(const dec128* a,const dec128* b,dec128* out,size_t count,unsigned int scale,bool* overflow){
+  bool of=!dec128_validScale(scale),elementOverflow;
+  for(size_t i=0;i<count;i++){
+    out[i]=dec128_mult(a[i],b[i],scale,&elementOverflow);
+    of|=elementOverflow;
+  }
+  if(overflow!=NULL){
+    *overflow=of;
+  }
+}
+// converts array from one scale to another
+void dec128_rescaleArray(const dec128* values,dec128* out,size_t count,unsigned int fromScale,unsigned int toScale,bool* overflow){
+  bool of=!(dec128_validScale(fromScale)&&dec128_validScale(toScale)),elementOverflow;
+  for(size_t i=0;i<count;i++){
+    out[i]=dec128_rescale(values[i],fromScale,toScale,&elementOverflow);
+    of|=elementOverflow;
+  }
+  if(overflow!=NULL){
+    *overflow=of;
+  }
+}
+// sum of all values, sets overflow (if not NULL) if an intermediate sum is out of range
+dec128 dec128_sum(const dec128* values,size_t count,bool* overflow){
+  return i128_sum(values,count,overflow);
+}
+
+// rational numbers
+
+// signed 256-bit product of a and b in twos complement
+static void r128_signedBigMult(i128 a,i128 b,i128* hi,i128* low){
+  *low=i128_bigMult(a,b,hi);
+  // correct unsigned product for negative factors
+  if(a.hi&I64_HI_BIT){
+    *hi=i128_sub(*hi,b);
+  }
+  if(b.hi&I64_HI_BIT){
+    *hi=i128_sub(*hi,a);
+  }
+}
+// true if the signed 256-bit number [hi:low] fits in 128 bits
+static bool r128_fits(i128 hi,i128 low){
+  uint64_t ext=(low.hi&I64_HI_BIT)?I64_MAX:0;
+  return hi.hi==ext&&hi.low==ext;
+}
+static bool r128_isZero(i128 x){
+  return (x.hi|x.low)==0;
+}
+// divides num and den by their gcd
+r128 r128_reduce(r128 x){
+  i128 g=i128_gcd(x.num,x.den);
+  if(g.hi!=0||g.low>1){
+    x.num=i128_divMod(x.num,g,NULL);
+    x.den=i128_unsignedDivMod(x.den,g,NULL);
+  }
+  return x;
+}
+// creates rational number from unsigned magnitudes,
+// reduces if the value does not fit otherwise
+static r128 r128_fromMagnitudes(bool negative,i128 num,i128 den,bool* overflow){
+  bool numFits=!(num.hi&I64_HI_BIT)||(negative&&num.hi==I64_HI_BIT&&num.low==0);
+  if(!numFits||(den.hi&I64_HI_BIT)){
+    i128 g=i128_unsignedGcd(num,den);
+    num=i128_unsignedDivMod(num,g,NULL);
+    den=i128_unsignedDivMod(den,g,NULL);
+    numFits=!(num.hi&I64_HI_BIT)||(negative&&num.hi==I64_HI_BIT&&num.low==0);
+    if(!numFits||(den.hi&I64_HI_BIT)){
+      *overflow=true;
+      return (r128){.num={.hi=0,.low=0},.den={.hi=0,.low=1}};
+    }
+  }
+  return (r128){.num=negative?i128_negate(num):num,.den=den};
+}
+// num/den, sets overflow (if not NULL) if den is zero or the value is out of range
+r128 r128_make(i128 num,i128 den,bool* overflow){
+  bool of=r128_isZero(den);
+  r128 r={.num={.hi=0,.low=0},.den={.hi=0,.low=1}};
+  if(!of){
+    r=r128_fromMagnitudes((num.hi^den.hi)>>63,i128_abs(num),i128_abs(den),&of);
+  }
+  if(overflow!=NULL){
+    *overflow=of;
+  }
+  return r;
+}
+// signed 256-bit value of a*b+c*d or a*b-c*d
+static void r128_crossSum(i128 a,i128 b,i128 c,i128 d,bool subtract,i128* hi,i128* low){
+  i128 hi2,low2;
+  r128_signedBigMult(a,b,hi,low);
+  r128_signedBigMult(c,d,&hi2,&low2);
+  if(subtract){
+    hi2=i128_not(hi2);
+    low2=i128_negate(low2);
+    if(r128_isZero(low2)){
+      hi2=i128_add(hi2,(i128){.hi=0,.low=1});
+    }
+  }
+  *low=i128_add(*low,low2);
+  *hi=i128_add(*hi,hi2);
+  if(i128_unsignedCompare(*low,low2)<0){
+    *hi=i128_add(*hi,(i128){.hi=0,.low=1});
+  }
+}
+static r128 r128_addSub(r128 a,r128 b,bool subtract,bool* overflow){
+  i128 hi,low,denHi;
+  // without normalization: (a.num*b.den+-b.num*a.den)/(a.den*b.den)
+  r128_crossSum(a.num,b.den,b.num,a.den,subtract,&hi,&low);
+  i128 den=i128_bigMult(a.den,b.den,&denHi);
+  bool of=false;
+  r128 r={.num=low,.den=den};
+  if(!r128_fits(hi,low)||!r128_isZero(denHi)||(den.hi&I64_HI_BIT)){
+    // reduce operands and divide by gcd of denominators, the result is then fully reduced
+    a=r128_reduce(a);
+    b=r128_reduce(b);
+    i128 g=i128_unsignedGcd(a.den,b.den);
+    i128 da=i128_unsignedDivMod(a.den,g,NULL);
+    i128 db=i128_unsignedDivMod(b.den,g,NULL);
+    r128_crossSum(a.num,db,b.num,da,subtract,&hi,&low);
+    // remaining common factors divide g
+    i128 g2;
+    if(r128_fits(hi,low)){
+      g2=i128_gcd(low,g);
+      r.num=i128_divMod(low,g2,NULL);
+    }else{
+      // numerator only fits after division
+      bool negative=hi.hi>>63;
+      if(negative){
+        hi=i128_not(hi);
+        low=i128_negate(low);
+        if(r128_isZero(low)){
+          hi=i128_add(hi,(i128){.hi=0,.low=1});
+        }
+      }
+      uint32_t u[DEC128_LIMBS],q[DEC128_LIMBS];
+      dec128_toLimbs(hi,low,u);
+      g2=i128_unsignedGcd(dec128_divLimbs(u,g,q),g);
+      dec128_divLimbs(u,g2,q);
+      r.num=dec128_fromMagnitude(q,negative,&of);
+    }
+    r.den=i128_bigMult(da,i128_unsignedDivMod(b.den,g2,NULL),&denHi);
+    of|=!r128_isZero(denHi)||(r.den.hi&I64_HI_BIT);
+    if(of){
+      r=(r128){.num={.hi=0,.low=0},.den={.hi=0,.low=1}};
+    }
+  }
+  if(overflow!=NULL){
+    *overflow=of;
+  }
+  return r;
+}
+// a+b, sets overflow (if not NULL) if the result does not fit
+r128 r128_add(r128 a,r128 b,bool* overflow){
+  return r128_addSub(a,b,false,overflow);
+}
+// a-b, sets overflow (if not NULL) if the result does not fit
+r128 r128_sub(r128 a,r128 b,bool* overflow){
+  return r128_addSub(a,b,true,overflow);
+}
+// (n1*n2)/(d1*d2) for unsigned magnitudes
+static r128 r128_multMagnitudes(bool negative,i128 n1,i128 d1,i128 n2,i128 d2,bool* overflow){
+  i128 numHi,denHi;
+  i128 num=i128_bigMult(n1,n2,&numHi);
+  i128 den=i128_bigMult(d1,d2,&denHi);
+  bool of=false;
+  r128 r;
+  if(r128_isZero(numHi)&&r128_isZero(denHi)){
+    r=r128_fromMagnitudes(negative,num,den,&of);
+  }else{
+    // cross reduce
+    i128 g=i128_unsignedGcd(n1,d1);
+    n1=i128_unsignedDivMod(n1,g,NULL);
+    d1=i128_unsignedDivMod(d1,g,NULL);
+    g=i128_unsignedGcd(n2,d2);
+    n2=i128_unsignedDivMod(n2,g,NULL);
+    d2=i128_unsignedDivMod(d2,g,NULL);
+    g=i128_unsignedGcd(n1,d2);
+    n1=i128_unsignedDivMod(n1,g,NULL);
+    d2=i128_unsignedDivMod(d2,g,NULL);
+    g=i128_unsignedGcd(n2,d1);
+    n2=i128_unsignedDivMod(n2,g,NULL);
+    d1=i128_unsignedDivMod(d1,g,NULL);
+    num=i128_bigMult(n1,n2,&numHi);
+    den=i128_bigMult(d1,d2,&denHi);
+    if(r128_isZero(numHi)&&r128_isZero(denHi)){
+      r=r128_fromMagnitudes(negative,num,den,&of);
+    }else{
+      of=true;
+      r=(r128){.num={.hi=0,.low=0},.den={.hi=0,.low=1}};
+    }
+  }
+  if(overflow!=NULL){
+    *overflow=of;
+  }
+  return r;
+}
+// a*b, sets overflow (if not NULL) if the result does not fit
+r128 r128_mult(r128 a,r128 b,bool* overflow){
+  return r128_multMagnitudes((a.num.hi^b.num.hi)>>63,i128_abs(a.num),a.den,i128_abs(b.num),b.den,overflow);
+}
+// a/b, sets overflow (if not NULL) if b is zero or the result does not fit
+r128 r128_div(r128 a,r128 b,bool* overflow){
+  if(r128_isZero(b.num)){
+    if(overflow!=NULL){
+      *overflow=true;
+    }
+    return (r128){.num={.hi=0,.low=0},.den={.hi=0,.low=1}};
+  }
+  return r128_multMagnitudes((a.num.hi^b.num.hi)>>63,i128_abs(a.num),a.den,b.den,i128_abs(b.num),overflow);
+}
+// compares a and b by cross multiplication ( exact, no normalization needed )
+int r128_compare(r128 a,r128 b){
+  i128 hi,low,hi2,low2;
+  r128_signedBigMult(a.num,b.den,&hi,&low);
+  r128_signedBigMult(b.num,a.den,&hi2,&low2);
+  int c=i128_compare(hi,hi2);
+  return c!=0?c:i128_unsignedCompare(low,low2);
+}
+// converts to nearest f128 ( ties to even )
+f128 r128_toF128(r128 x){
+  bool negative=x.num.hi>>63;
+  i128 num=i128_abs(x.num);
+  if(r128_isZero(num))
+    return (f128){.hi=0,.low=0};
+  // scale numerator or denominator such that the quotient has 114 or 115 bits
+  int s=114-i128_highestSetBit(num)+i128_highestSetBit(x.den);
+  uint32_t u[DEC128_LIMBS],q[DEC128_LIMBS];
+  i128 zero={.hi=0,.low=0};
+  if(s>=128){
+    dec128_toLimbs(i128_leftShift(num,s-128),zero,u);
+  }else if(s>0){
+    dec128_toLimbs(i128_logicalRightShift(num,128-s),i128_leftShift(num,s),u);
+  }else{
+    dec128_toLimbs(zero,num,u);
+  }
+  i128 rem=dec128_divLimbs(u,s<0?i128_leftShift(x.den,-s):x.den,q);
+  bool sticky=!r128_isZero(rem);
+  i128 quotient={
+    .hi=((uint64_t)q[3]<<32)|q[2],
+    .low=((uint64_t)q[1]<<32)|q[0]
+  };
+  // round to 113 significant bits
+  int shift=i128_highestSetBit(quotient)-113;
+  uint64_t roundBits=quotient.low&((1ull<<shift)-1);
+  uint64_t half=1ull<<(shift-1);
+  i128 mantissa=i128_logicalRightShift(quotient,shift);
+  if(roundBits>half||(roundBits==half&&(sticky||(mantissa.low&1)))){
+    mantissa=i128_add(mantissa,(i128){.hi=0,.low=1});
+    if(mantissa.hi>>49){
+      mantissa=i128_logicalRightShift(mantissa,1);
+      shift++;
+    }
+  }
+  // leading bit of mantissa has value 2^(112+shift-s), values are always normal
+  uint64_t exp=(uint64_t)(F128_EXP_BIAS+112+shift-s);
+  return (f128){
+    .hi=((uint64_t)negative<<63)|(exp<<F128_HI_EXP_SHIFT)|(mantissa.hi&F128_HI_MANTISSA_MASK),
+    .low=mantissa.low
+  };
+}
+
+// trace recording and replay
+// a record is the operation ( 1 byte ) followed by the words a.hi,a.low,b.hi,b.low,q.hi,q.low,r.hi,r.low
+// of operands, result and remainder in host byte order, the remainder is zero for i128_mult
+
+#define I128_TRACE_RECORD_SIZE (1+8*sizeof(uint64_t))
+// maximum number of differing results printed by i128_traceReplay
+#define I128_TRACE_MAX_DIFFS 10
+
+#ifdef I128_TRACE
+static FILE* i128_traceFile;
+static I128_THREAD_LOCAL int i128_traceDepth;
+
+// start recording to file at path, returns false if the file cannot be opened
+bool i128_traceStart(const char* path){
+  if(i128_traceFile!=NULL){
+    fclose(i128_traceFile);
+  }
+  i128_traceFile=fopen(path,"wb");
+  return i128_traceFile!=NULL;
+}
+void i128_traceStop(void){
+  if(i128_traceFile!=NULL){
+    fclose(i128_traceFile);
+    i128_traceFile=NULL;
+  }
+}
+static void i128_traceWrite(i128_op op,i128 a,i128 b,i128 q,i128 r){
+  if(i128_traceDepth!=0||i128_traceFile==NULL)
+    return;
+  unsigned char record[I128_TRACE_RECORD_SIZE];
+  uint64_t words[8]={a.hi,a.low,b.hi,b.low,q.hi,q.low,r.hi,r.low};
+  record[0]=(unsigned char)op;
+  memcpy(record+1,words,sizeof(words));
+  // single write per record, records of different threads do not interleave
+  fwrite(record,I128_TRACE_RECORD_SIZE,1,i128_traceFile);
+}
+i128 i128_mult(i128 a,i128 b){
+  i128_traceDepth++;
+  i128 res=i128_multUntraced(a,b);
+  i128_traceDepth--;
+  i128_traceWrite(I128_OP_MULT,a,b,res,(i128){.hi=0,.low=0});
+  return res;
+}
+i128 i128_unsignedDivMod(i128 a,i128 b,i128* mod){
+  i128 rem;
+  i128_traceDepth++;
+  i128 res=i128_unsignedDivModUntraced(a,b,&rem);
+  i128_traceDepth--;
+  i128_traceWrite(I128_OP_UNSIGNED_DIV_MOD,a,b,res,rem);
+  if(mod!=NULL){
+    *mod=rem;
+  }
+  return res;
+}
+i128 i128_divMod(i128 a,i128 b,i128* mod){
+  i128 rem;
+  i128_traceDepth++;
+  i128 res=i128_divModUntraced(a,b,&rem);
+  i128_traceDepth--;
+  i128_traceWrite(I128_OP_DIV_MOD,a,b,res,rem);
+  if(mod!=NULL){
+    *mod=rem;
+  }
+  return res;
+}
+#endif
+
+typedef struct{
+  i128_op op;
+  i128 a;
+  i128 b;
+  i128 expected[2];// result and remainder in trace
+  i128 actual[2];// result and remainder of current build
+}i128_traceEntry;
+
+static void i128_traceExecute(i128_traceEntry* entry){
+  switch(entry->op){
+    case I128_OP_MULT:
+      entry->actual[0]=I128_UNTRACED(i128_mult)(entry->a,entry->b);
+      entry->actual[1]=(i128){.hi=0,.low=0};
+      break;
+    case I128_OP_UNSIGNED_DIV_MOD:
+      entry->actual[0]=I128_UNTRACED(i128_unsignedDivMod)(entry->a,entry->b,&entry->actual[1]);
+      break;
+    default:
+      entry->actual[0]=I128_UNTRACED(i128_divMod)(entry->a,entry->b,&entry->actual[1]);
+      break;
+  }
+}
+// reads trace at path, sorted by operation, stores number of entries in count
+static i128_traceEntry* i128_traceRead(const char* path,size_t* count){
+  FILE* in=fopen(path,"rb");
+  if(in==NULL)
+    return NULL;
+  size_t n=0,capacity=1024;
+  size_t perOp[I128_OP_COUNT]={0};
+  i128_traceEntry* entries=malloc(capacity*sizeof(i128_traceEntry));
+  unsigned char record[I128_TRACE_RECORD_SIZE];
+  while(entries!=NULL&&fread(record,I128_TRACE_RECORD_SIZE,1,in)==1){
+    if(record[0]>=I128_OP_COUNT)
+      continue;
+    if(n==capacity){
+      capacity*=2;
+      i128_traceEntry* grown=realloc(entries,capacity*sizeof(i128_traceEntry));
+      if(grown==NULL){
+        free(entries);
+        entries=NULL;
+        break;
+      }
+      entries=grown;
+    }
+    uint64_t words[8];
+    memcpy(words,record+1,sizeof(words));
+    entries[n++]=(i128_traceEntry){
+      .op=(i128_op)record[0],
+      .a={.hi=words[0],.low=words[1]},
+      .b={.hi=words[2],.low=words[3]},
+      .expected={{.hi=words[4],.low=words[5]},{.hi=words[6],.low=words[7]}}
+    };
+    perOp[record[0]]++;
+  }
+  fclose(in);
+  if(entries==NULL)
+    return NULL;
+  // counting sort by operation, such that each operation is timed in one loop
+  i128_traceEntry* sorted=malloc((n>0?n:1)*sizeof(i128_traceEntry));
+  if(sorted!=NULL){
+    size_t start[I128_OP_COUNT];
+    size_t sum=0;
+    for(int op=0;op<I128_OP_COUNT;op++){
+      start[op]=sum;
+      sum+=perOp[op];
+    }
+    for(size_t i=0;i<n;i++){
+      sorted[start[entries[i].op]++]=entries[i];
+    }
+  }
+  free(entries);
+  *count=n;
+  return sorted;
+}
+// re-executes the operations in the trace at path with the current build,
+// prints number of calls, time per call, throughput and number of results that differ from the trace
+// returns false if the trace cannot be read
+bool i128_traceReplay(const char* path,FILE* out){
+  size_t n;
+  i128_traceEntry* entries=i128_traceRead(path,&n);
+  if(entries==NULL)
+    return false;
+  int printed=0;
+  for(size_t first=0;first<n;){
+    i128_op op=entries[first].op;
+    size_t end=first;
+    while(end<n&&entries[end].op==op){
+      end++;
+    }
+    clock_t start=clock();
+    for(size_t i=first;i<end;i++){
+      i128_traceExecute(&entries[i]);
+    }
+    double seconds=(double)(clock()-start)/CLOCKS_PER_SEC;
+    size_t diffs=0;
+    for(size_t i=first;i<end;i++){
+      i128* e=entries[i].expected;
+      i128* a=entries[i].actual;
+      if(e[0].hi!=a[0].hi||e[0].low!=a[0].low||e[1].hi!=a[1].hi||e[1].low!=a[1].low){
+        diffs++;
+        if(printed++<I128_TRACE_MAX_DIFFS){
+          fprintf(out,"diff %s %016"PRIx64" %016"PRIx64" %016"PRIx64" %016"PRIx64": %016"PRIx64" %016"PRIx64" %016"PRIx64" %016"PRIx64" -> %016"PRIx64" %016"PRIx64" %016"PRIx64" %016"PRIx64"\n",
+            i128_opNames[op],entries[i].a.hi,entries[i].a.low,entries[i].b.hi,entries[i].b.low,
+            e[0].hi,e[0].low,e[1].hi,e[1].low,a[0].hi,a[0].low,a[1].hi,a[1].low);
+        }
+      }
+    }
+    size_t calls=end-first;
+    fprintf(out,"%-14s calls: %zu ns/call: %.1f Mops/s: %.2f diffs: %zu\n",i128_opNames[op],calls,
+      seconds*1e9/(double)calls,seconds>0?(double)calls/seconds*1e-6:0.0,diffs);
+    first=end;
+  }
+  free(entries);
+  return true;
+}
+
+int main(int argc,char** argv){
+  // i128 --replay <trace>: benchmark current build with recorded operations
+  if(argc==3&&strcmp(argv[1],"--replay")==0)
+    return i128_traceReplay(argv[2],stdout)?0:1;
+  // i128 --bench <count>: compare gcd, extended gcd, sqrt and pow with versions based on i128_divMod
+  if(argc==3&&strcmp(argv[1],"--bench")==0)
+    return i128_numberTheoryBenchmark(strtoull(argv[2],NULL,10),stdout)?0:1;
+#ifdef I128_TRACE
+  // i128 --trace <trace>: record operations of this demo
+  if(argc==3&&strcmp(argv[1],"--trace")==0&&!i128_traceStart(argv[2])){
+    fprintf(stderr,"cannot open %s\n",argv[2]);
+    return 1;
+  }
+#endif
   i128 a={.hi=0x8000000000000000,.low=0};
   i128 b={.hi=0,.low=1};
   i128 c=i128_sub(a,b);
@@ -305,5 +2228,104 @@ int main(void){
   printf("%016lx %016lx\n",c.hi,c.low);
   c=i128_add(c,m);
   printf("%016lx %016lx\n",c.hi,c.low);
+  i128 values[4]={a,b,c,m};
+  uint64_t words[16];
+  size_t n=i128_pack(values,4,words,NULL);
+  i128_unpack(words,4,values);
+  printf("%zu words\n",n);
+  for(int i=0;i<4;i++){
+    printf("%016lx %016lx\n",values[i].hi,values[i].low);
+  }
+  i128_pcg rng;
+  i128_pcgSeed(&rng,(i128){.hi=0,.low=42},(i128){.hi=0,.low=54});
+  i128_pcgFill(&rng,values,4);
+  for(int i=0;i<4;i++){
+    printf("%016lx %016lx\n",values[i].hi,values[i].low);
+  }
+  c=i128_pcgBounded(&rng,(i128){.hi=0,.low=1000});
+  printf("%016lx %016lx\n",c.hi,c.low);
+  i128 x,y;
+  c=i128_extendedGcd(a,b,&x,&y);
+  printf("%016lx %016lx\n",c.hi,c.low);
+  printf("%016lx %016lx\n",x.hi,x.low);
+  printf("%016lx %016lx\n",y.hi,y.low);
+  c=i128_sqrt(a);
+  printf("%016lx %016lx\n",c.hi,c.low);
+  bool overflow;
+  c=i128_pow((i128){.hi=0,.low=3},80,&overflow);
+  printf("%016lx %016lx %d\n",c.hi,c.low,overflow);
+  dec128 price,rate;
+  char buffer[DEC128_FORMAT_SIZE];
+  dec128_parse("1234.5678",4,&price);
+  dec128_parse("-0.0725",4,&rate);
+  dec128_format(dec128_mult(price,rate,4,NULL),4,buffer);
+  printf("%s\n",buffer);
+  dec128_format(dec128_div(price,rate,4,NULL),4,buffer);
+  printf("%s\n",buffer);
+  // scales above DEC128_MAX_SCALE are rejected
+  dec128_mult(price,rate,DEC128_MAX_SCALE+2,&overflow);
+  printf("invalid scale: overflow %d parse %d\n",overflow,dec128_parse("1.5",DEC128_MAX_SCALE+1,&price));
+  r128 third=r128_make((i128){.hi=0,.low=1},(i128){.hi=0,.low=3},NULL);
+  r128 sixth=r128_make((i128){.hi=0,.low=1},(i128){.hi=0,.low=6},NULL);
+  r128 sum=r128_add(third,sixth,NULL);
+  printf("%016lx %016lx / %016lx %016lx\n",sum.num.hi,sum.num.low,sum.den.hi,sum.den.low);
+  f128 f=r128_toF128(third);
+  printf("%016lx %016lx\n",f.hi,f.low);
+  i128 deltas[4]={{.hi=0,.low=5},{.hi=0,.low=7},{.hi=I64_MAX,.low=I64_MAX-2},{.hi=0,.low=1}};
+  uint64_t accounts[4]={1,1,2,2};
+  i128 balances[4];
+  i128_segmentedScanByKey(deltas,accounts,balances,4,0,(i128){.hi=0,.low=0},NULL);
+  for(int i=0;i<4;i++){
+    printf("%016lx %016lx\n",balances[i].hi,balances[i].low);
+  }
+  // scans over blocks have the same results as the sequential scans
+  {
+    enum{SCAN_COUNT=37};
+    i128 scanValues[SCAN_COUNT],expected[SCAN_COUNT],blocked[SCAN_COUNT];
+    bool starts[SCAN_COUNT];
+    uint64_t keys[SCAN_COUNT];
+    i128_pcg rng;
+    i128_pcgSeed(&rng,(i128){.hi=0,.low=42},(i128){.hi=0,.low=7});
+    for(int i=0;i<SCAN_COUNT;i++){
+      scanValues[i]=i%3==0?i128_pcgNext(&rng):i128_arithmeticRightShift(i128_pcgNext(&rng),40);// some running sums overflow
+      starts[i]=i%5==3;
+      keys[i]=(uint64_t)i/4;
+    }
+    i128 offset={.hi=0,.low=3};
+    bool ok=true;
+    for(size_t blocks=1;blocks<=SCAN_COUNT+1;blocks++){
+      for(int kind=0;kind<4;kind++){
+        bool of,blockedOf;
+        i128 r,blockedR;
+        memcpy(blocked,scanValues,sizeof(blocked));// in place
+        switch(kind){
+          case 0:
+            r=i128_inclusiveScan(scanValues,expected,SCAN_COUNT,offset,&of);
+            blockedR=i128_inclusiveScanBlocked(blocked,blocked,SCAN_COUNT,offset,blocks,&blockedOf);
+            break;
+          case 1:
+            r=i128_exclusiveScan(scanValues,expected,SCAN_COUNT,offset,&of);
+            blockedR=i128_exclusiveScanBlocked(blocked,blocked,SCAN_COUNT,offset,blocks,&blockedOf);
+            break;
+          case 2:
+            r=i128_segmentedScan(scanValues,starts,expected,SCAN_COUNT,offset,&of);
+            blockedR=i128_segmentedScanBlocked(blocked,starts,blocked,SCAN_COUNT,offset,blocks,&blockedOf);
+            break;
+          default:
+            r=i128_segmentedScanByKey(scanValues,keys,expected,SCAN_COUNT,0,offset,&of);
+            blockedR=i128_segmentedScanByKeyBlocked(blocked,keys,blocked,SCAN_COUNT,0,offset,blocks,&blockedOf);
+            break;
+        }
+        ok&=memcmp(expected,blocked,sizeof(blocked))==0&&i128_unsignedCompare(r,blockedR)==0&&of==blockedOf;
+      }
+    }
+    printf("blocked scans: %s\n",ok?"ok":"differ");
+  }
+#ifdef I128_TRACE
+  i128_traceStop();
+#endif
+#ifdef I128_INSTRUMENT
+  i128_statsDump(stdout);
+#endif
 }
 